@@ -8,6 +8,7 @@ module mcu_top (
     dma_scb.controller usb_dma_scb,
     sd_scb.controller sd_scb,
     dma_scb.controller sd_dma_scb,
+    copy_scb.controller copy_scb,
     flash_scb.controller flash_scb,
     vendor_scb.controller vendor_scb,
 
@@ -77,7 +78,9 @@ module mcu_top (
         CMD_MEM_WRITE,
         CMD_USB_STATUS,
         CMD_USB_READ,
-        CMD_USB_WRITE
+        CMD_USB_WRITE,
+        CMD_USB_READ_BURST,
+        CMD_USB_WRITE_BURST
     } cmd_e;
 
     phase_e phase;
@@ -97,6 +100,15 @@ module mcu_top (
     logic [15:0] mem_wdata;
     logic mem_word_select;
 
+    logic usb_burst_header;
+    logic [7:0] usb_burst_count;
+    logic [7:0] usb_burst_remaining;
+    logic [10:0] usb_tx_free;
+
+    always_comb begin
+        usb_tx_free = 11'd1024 - usb_scb.tx_count;
+    end
+
     always_ff @(posedge clk) begin
         fifo_bus.rx_read <= 1'b0;
         fifo_bus.tx_write <= 1'b0;
@@ -136,12 +148,29 @@ module mcu_top (
                         if (rdata == CMD_USB_WRITE) begin
                             phase <= PHASE_DATA;
                         end
+
+                        if (rdata == CMD_USB_WRITE_BURST) begin
+                            usb_burst_header <= 1'b1;
+                            usb_burst_count <= (usb_tx_free > 11'd255) ? 8'd255 : usb_tx_free[7:0];
+                            phase <= PHASE_DATA;
+                        end
                     end
 
                     PHASE_ADDRESS: begin
                         address <= rdata;
                         phase <= PHASE_DATA;
 
+                        if (cmd == CMD_USB_READ_BURST) begin
+                            usb_burst_header <= 1'b1;
+                            if (usb_scb.rx_count < {3'd0, rdata}) begin
+                                usb_burst_count <= usb_scb.rx_count[7:0];
+                                usb_burst_remaining <= usb_scb.rx_count[7:0];
+                            end else begin
+                                usb_burst_count <= rdata;
+                                usb_burst_remaining <= rdata;
+                            end
+                        end
+
                         if (cmd == CMD_REG_READ) begin
                             reg_read <= 1'b1;
                         end
@@ -200,6 +229,22 @@ module mcu_top (
                             fifo_bus.tx_wdata <= rdata;
                             phase <= PHASE_NOP;
                         end
+
+                        if (cmd == CMD_USB_READ_BURST) begin
+                            usb_burst_header <= 1'b0;
+                            if (usb_burst_remaining > 8'd0) begin
+                                fifo_bus.rx_read <= 1'b1;
+                                usb_burst_remaining <= usb_burst_remaining - 1'd1;
+                            end
+                        end
+
+                        if (cmd == CMD_USB_WRITE_BURST) begin
+                            usb_burst_header <= 1'b0;
+                            if (!usb_burst_header && !fifo_bus.tx_full) begin
+                                fifo_bus.tx_write <= 1'b1;
+                                fifo_bus.tx_wdata <= rdata;
+                            end
+                        end
                     end
 
                     PHASE_NOP: begin end
@@ -251,6 +296,14 @@ module mcu_top (
             CMD_USB_WRITE: begin
                 wdata = 8'h00;
             end
+
+            CMD_USB_READ_BURST: begin
+                wdata = usb_burst_header ? usb_burst_count : fifo_bus.rx_rdata;
+            end
+
+            CMD_USB_WRITE_BURST: begin
+                wdata = usb_burst_header ? usb_burst_count : 8'h00;
+            end
         endcase
     end
 
@@ -358,7 +411,23 @@ module mcu_top (
         REG_VENDOR_SCR,
         REG_VENDOR_DATA,
         REG_DEBUG_0,
-        REG_DEBUG_1
+        REG_DEBUG_1,
+        REG_EVENTS,
+        REG_COPY_SOURCE,
+        REG_COPY_DESTINATION,
+        REG_COPY_LENGTH,
+        REG_COPY_SCR,
+        REG_COPY_CRC32,
+        REG_DD_BLOCK_ADDRESS,
+        REG_DD_BLOCK_SCR,
+        REG_SAVE_DIRTY_0,
+        REG_SAVE_DIRTY_1,
+        REG_SAVE_DIRTY_2,
+        REG_SAVE_DIRTY_3,
+        REG_SAVE_DIRTY_4,
+        REG_SAVE_DIRTY_5,
+        REG_SAVE_DIRTY_6,
+        REG_SAVE_DIRTY_7
     } reg_address_e;
 
     logic bootloader_skip;
@@ -367,6 +436,84 @@ module mcu_top (
 
     logic dd_bm_ack;
 
+    logic [2:0] save_dirty_word;
+
+    always_comb begin
+        save_dirty_word = 3'(address - REG_SAVE_DIRTY_0);
+    end
+
+
+    // Pending events and MCU interrupt
+
+    logic [9:0] events_pending;
+    logic [4:0] events_latched;
+    logic [9:0] events_enabled;
+
+    logic [2:0] usb_status_last;
+    logic usb_dma_busy_last;
+    logic [15:0] save_count_last;
+    logic button_last;
+    logic sd_det_last;
+
+    always_comb begin
+        events_pending = {
+            events_latched,
+            ~fifo_bus.rx_empty,
+            n64_scb.rtc_pending,
+            1'b0,
+            (
+                dd_scb.hard_reset |
+                dd_scb.cmd_pending |
+                dd_scb.bm_pending |
+                dd_scb.bm_start_pending |
+                dd_scb.bm_stop_pending |
+                dd_bm_ack
+            ),
+            n64_scb.cfg_pending
+        };
+    end
+
+    always_ff @(posedge clk) begin
+        usb_status_last <= {usb_scb.pwrsav, usb_scb.reset_state, usb_scb.reset_pending};
+        usb_dma_busy_last <= usb_dma_scb.busy;
+        save_count_last <= n64_scb.save_count;
+        button_last <= button_ff[2];
+        sd_det_last <= sd_det_ff[2];
+
+        mcu_int <= |(events_pending & events_enabled);
+
+        if (reg_write && (address == REG_EVENTS)) begin
+            events_enabled <= reg_wdata[25:16];
+            events_latched <= events_latched & ~reg_wdata[9:5];
+        end
+
+        if (usb_status_last != {usb_scb.pwrsav, usb_scb.reset_state, usb_scb.reset_pending}) begin
+            events_latched[0] <= 1'b1;
+        end
+
+        if (usb_dma_busy_last && !usb_dma_scb.busy) begin
+            events_latched[1] <= 1'b1;
+        end
+
+        if (save_count_last != n64_scb.save_count) begin
+            events_latched[2] <= 1'b1;
+        end
+
+        if (button_last != button_ff[2]) begin
+            events_latched[3] <= 1'b1;
+        end
+
+        if (sd_det_last != sd_det_ff[2]) begin
+            events_latched[4] <= 1'b1;
+        end
+
+        if (reset) begin
+            mcu_int <= 1'b0;
+            events_latched <= 5'd0;
+            events_enabled <= 10'd0;
+        end
+    end
+
 
     // Register read logic
 
@@ -647,6 +794,81 @@ module mcu_top (
                         n64_scb.pi_debug[35:32]
                     };
                 end
+
+                REG_EVENTS: begin
+                    reg_rdata <= {
+                        6'd0,
+                        events_enabled,
+                        6'd0,
+                        events_pending
+                    };
+                end
+
+                REG_COPY_SOURCE: begin
+                    reg_rdata <= {
+                        5'd0,
+                        copy_scb.source_address
+                    };
+                end
+
+                REG_COPY_DESTINATION: begin
+                    reg_rdata <= {
+                        5'd0,
+                        copy_scb.destination_address
+                    };
+                end
+
+                REG_COPY_LENGTH: begin
+                    reg_rdata <= {
+                        5'd0,
+                        copy_scb.transfer_length
+                    };
+                end
+
+                REG_COPY_SCR: begin
+                    reg_rdata <= {
+                        copy_scb.fill_data,
+                        11'd0,
+                        copy_scb.crc32,
+                        copy_scb.busy,
+                        copy_scb.fill,
+                        2'b00
+                    };
+                end
+
+                REG_COPY_CRC32: begin
+                    reg_rdata <= copy_scb.crc32_result;
+                end
+
+                REG_DD_BLOCK_ADDRESS: begin
+                    reg_rdata <= {
+                        5'd0,
+                        dd_scb.block_address
+                    };
+                end
+
+                REG_DD_BLOCK_SCR: begin
+                    reg_rdata <= {
+                        dd_scb.block_sector,
+                        dd_scb.block_sectors,
+                        dd_scb.block_sector_size,
+                        4'd0,
+                        dd_scb.block_active,
+                        dd_scb.block_write,
+                        2'b00
+                    };
+                end
+
+                REG_SAVE_DIRTY_0,
+                REG_SAVE_DIRTY_1,
+                REG_SAVE_DIRTY_2,
+                REG_SAVE_DIRTY_3,
+                REG_SAVE_DIRTY_4,
+                REG_SAVE_DIRTY_5,
+                REG_SAVE_DIRTY_6,
+                REG_SAVE_DIRTY_7: begin
+                    reg_rdata <= n64_scb.save_dirty[{save_dirty_word, 5'd0} +: 32];
+                end
             endcase
         end
     end
@@ -674,11 +896,14 @@ module mcu_top (
         sd_dma_scb.start <= 1'b0;
         sd_dma_scb.stop <= 1'b0;
 
+        copy_scb.start <= 1'b0;
+        copy_scb.stop <= 1'b0;
+
         n64_scb.cfg_done <= 1'b0;
         n64_scb.cfg_error <= 1'b0;
         n64_scb.cfg_irq <= 1'b0;
 
-        n64_scb.flashram_done <= 1'b0;
+        n64_scb.save_dirty_clear <= 1'b0;
 
         n64_scb.rtc_done <= 1'b0;
 
@@ -688,6 +913,8 @@ module mcu_top (
         dd_scb.bm_stop_clear <= 1'b0;
         dd_scb.bm_clear <= 1'b0;
         dd_scb.bm_ready <= 1'b0;
+        dd_scb.block_start <= 1'b0;
+        dd_scb.block_stop <= 1'b0;
 
         vendor_scb.control_valid <= 1'b0;
 
@@ -704,8 +931,8 @@ module mcu_top (
         end
 
         if (reset) begin
-            mcu_int <= 1'b0;
             sd_scb.clock_mode <= 2'd0;
+            sd_scb.dat_stream <= 1'b0;
             n64_scb.rom_extended_enabled <= 1'b0;
             n64_scb.eeprom_16k_mode <= 1'b0;
             n64_scb.eeprom_enabled <= 1'b0;
@@ -772,9 +999,11 @@ module mcu_top (
                         n64_scb.sram_enabled,
                         n64_scb.rom_shadow_enabled,
                         n64_scb.rom_write_enabled,
-                        bootloader_skip,
-                        n64_scb.bootloader_enabled
-                    } <= reg_wdata[11:0];
+                        bootloader_skip
+                    } <= reg_wdata[11:1];
+                    if (reg_wdata[12]) begin
+                        n64_scb.bootloader_enabled <= reg_wdata[0];
+                    end
                 end
 
                 REG_CFG_DATA_0: begin
@@ -793,10 +1022,6 @@ module mcu_top (
                     } <= reg_wdata[11:9];
                 end
 
-                REG_FLASHRAM_SCR: begin
-                    n64_scb.flashram_done <= reg_wdata[0];
-                end
-
                 REG_FLASH_SCR: begin
                     flash_scb.erase_pending <= 1'b1;
                     flash_scb.erase_block <= reg_wdata[23:16];
@@ -839,6 +1064,7 @@ module mcu_top (
                 end
 
                 REG_SD_DAT: begin
+                    sd_scb.dat_stream <= reg_wdata[14];
                     sd_scb.dat_blocks <= reg_wdata[11:4];
                     sd_scb.dat_stop <= reg_wdata[3];
                     sd_scb.dat_start_read <= reg_wdata[2];
@@ -891,6 +1117,33 @@ module mcu_top (
                     dd_scb.drive_id <= reg_wdata[15:0];
                 end
 
+                REG_DD_BLOCK_ADDRESS: begin
+                    dd_scb.block_address <= reg_wdata[26:0];
+                end
+
+                REG_DD_BLOCK_SCR: begin
+                    dd_scb.block_sectors <= reg_wdata[23:16];
+                    dd_scb.block_sector_size <= reg_wdata[15:8];
+                    {
+                        dd_scb.block_write,
+                        dd_scb.block_stop,
+                        dd_scb.block_start
+                    } <= reg_wdata[2:0];
+                end
+
+                REG_SAVE_DIRTY_0,
+                REG_SAVE_DIRTY_1,
+                REG_SAVE_DIRTY_2,
+                REG_SAVE_DIRTY_3,
+                REG_SAVE_DIRTY_4,
+                REG_SAVE_DIRTY_5,
+                REG_SAVE_DIRTY_6,
+                REG_SAVE_DIRTY_7: begin
+                    n64_scb.save_dirty_clear <= 1'b1;
+                    n64_scb.save_dirty_clear_word <= save_dirty_word;
+                    n64_scb.save_dirty_clear_mask <= reg_wdata;
+                end
+
                 REG_VENDOR_SCR: begin
                     vendor_scb.control_valid <= 1'b1;
                     vendor_scb.control_wdata <= reg_wdata;
@@ -899,6 +1152,28 @@ module mcu_top (
                 REG_VENDOR_DATA: begin
                     vendor_scb.data_wdata <= reg_wdata;
                 end
+
+                REG_COPY_SOURCE: begin
+                    copy_scb.source_address <= reg_wdata[26:0];
+                end
+
+                REG_COPY_DESTINATION: begin
+                    copy_scb.destination_address <= reg_wdata[26:0];
+                end
+
+                REG_COPY_LENGTH: begin
+                    copy_scb.transfer_length <= reg_wdata[26:0];
+                end
+
+                REG_COPY_SCR: begin
+                    copy_scb.fill_data <= reg_wdata[31:16];
+                    copy_scb.crc32 <= reg_wdata[4];
+                    {
+                        copy_scb.fill,
+                        copy_scb.stop,
+                        copy_scb.start
+                    } <= reg_wdata[2:0];
+                end
             endcase
         end
     end
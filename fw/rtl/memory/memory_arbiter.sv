@@ -5,51 +5,75 @@ module memory_arbiter (
     n64_scb.arbiter n64_scb,
 
     mem_bus.memory n64_bus,
+    mem_bus.memory dd_copy_bus,
+    mem_bus.memory flashram_copy_bus,
     mem_bus.memory cfg_bus,
     mem_bus.memory usb_dma_bus,
     mem_bus.memory sd_dma_bus,
+    mem_bus.memory copy_bus,
 
     mem_bus.controller sdram_mem_bus,
     mem_bus.controller flash_mem_bus,
     mem_bus.controller bram_mem_bus
 );
 
-    typedef enum bit [1:0] {
+    typedef enum bit [2:0] {
         SOURCE_N64,
+        SOURCE_DD_COPY,
+        SOURCE_FLASHRAM_COPY,
         SOURCE_CFG,
         SOURCE_USB_DMA,
-        SOURCE_SD_DMA
+        SOURCE_SD_DMA,
+        SOURCE_COPY
     } e_source_request;
 
     logic n64_sdram_request;
+    logic dd_copy_sdram_request;
+    logic flashram_copy_sdram_request;
     logic cfg_sdram_request;
     logic usb_dma_sdram_request;
     logic sd_dma_sdram_request;
+    logic copy_sdram_request;
 
     logic n64_flash_request;
+    logic dd_copy_flash_request;
+    logic flashram_copy_flash_request;
     logic cfg_flash_request;
     logic usb_dma_flash_request;
     logic sd_dma_flash_request;
+    logic copy_flash_request;
 
     logic n64_bram_request;
+    logic dd_copy_bram_request;
+    logic flashram_copy_bram_request;
     logic cfg_bram_request;
     logic usb_dma_bram_request;
     logic sd_dma_bram_request;
+    logic copy_bram_request;
 
     assign n64_sdram_request = n64_bus.request && !n64_bus.address[26];
+    assign dd_copy_sdram_request = !n64_scb.pi_sdram_active && dd_copy_bus.request && !dd_copy_bus.address[26];
+    assign flashram_copy_sdram_request = !n64_scb.pi_sdram_active && flashram_copy_bus.request && !flashram_copy_bus.address[26];
     assign cfg_sdram_request = !n64_scb.pi_sdram_active && cfg_bus.request && !cfg_bus.address[26];
     assign usb_dma_sdram_request = !n64_scb.pi_sdram_active && usb_dma_bus.request && !usb_dma_bus.address[26];
     assign sd_dma_sdram_request = !n64_scb.pi_sdram_active && sd_dma_bus.request && !sd_dma_bus.address[26];
+    assign copy_sdram_request = !n64_scb.pi_sdram_active && copy_bus.request && !copy_bus.address[26];
 
     assign n64_flash_request = n64_bus.request && (n64_bus.address[26:24] == 3'b100);
+    assign dd_copy_flash_request = !n64_scb.pi_flash_active && dd_copy_bus.request && (dd_copy_bus.address[26:24] == 3'b100);
+    assign flashram_copy_flash_request = !n64_scb.pi_flash_active && flashram_copy_bus.request && (flashram_copy_bus.address[26:24] == 3'b100);
     assign cfg_flash_request = !n64_scb.pi_flash_active && cfg_bus.request && (cfg_bus.address[26:24] == 3'b100);
     assign usb_dma_flash_request = !n64_scb.pi_flash_active && usb_dma_bus.request && (usb_dma_bus.address[26:24] == 3'b100);
     assign sd_dma_flash_request = !n64_scb.pi_flash_active && sd_dma_bus.request && (sd_dma_bus.address[26:24] == 3'b100);
+    assign copy_flash_request = !n64_scb.pi_flash_active && copy_bus.request && (copy_bus.address[26:24] == 3'b100);
 
     assign n64_bram_request = n64_bus.request && (n64_bus.address[26:24] >= 3'b101);
+    assign dd_copy_bram_request = dd_copy_bus.request && (dd_copy_bus.address[26:24] >= 3'b101);
+    assign flashram_copy_bram_request = flashram_copy_bus.request && (flashram_copy_bus.address[26:24] >= 3'b101);
     assign cfg_bram_request = cfg_bus.request && (cfg_bus.address[26:24] >= 3'b101);
     assign usb_dma_bram_request = usb_dma_bus.request && (usb_dma_bus.address[26:24] >= 3'b101);
     assign sd_dma_bram_request = sd_dma_bus.request && (sd_dma_bus.address[26:24] >= 3'b101);
+    assign copy_bram_request = copy_bus.request && (copy_bus.address[26:24] >= 3'b101);
 
     e_source_request sdram_source_request;
 
@@ -60,9 +84,12 @@ module memory_arbiter (
             if (!sdram_mem_bus.request) begin
                 sdram_mem_bus.request <= (
                     n64_sdram_request ||
+                    dd_copy_sdram_request ||
+                    flashram_copy_sdram_request ||
                     cfg_sdram_request ||
                     usb_dma_sdram_request ||
-                    sd_dma_sdram_request
+                    sd_dma_sdram_request ||
+                    copy_sdram_request
                 );
 
                 if (n64_sdram_request) begin
@@ -71,6 +98,18 @@ module memory_arbiter (
                     sdram_mem_bus.address <= n64_bus.address;
                     sdram_mem_bus.wdata <= n64_bus.wdata;
                     sdram_source_request <= SOURCE_N64;
+                end else if (dd_copy_sdram_request) begin
+                    sdram_mem_bus.write <= dd_copy_bus.write;
+                    sdram_mem_bus.wmask <= dd_copy_bus.wmask;
+                    sdram_mem_bus.address <= dd_copy_bus.address;
+                    sdram_mem_bus.wdata <= dd_copy_bus.wdata;
+                    sdram_source_request <= SOURCE_DD_COPY;
+                end else if (flashram_copy_sdram_request) begin
+                    sdram_mem_bus.write <= flashram_copy_bus.write;
+                    sdram_mem_bus.wmask <= flashram_copy_bus.wmask;
+                    sdram_mem_bus.address <= flashram_copy_bus.address;
+                    sdram_mem_bus.wdata <= flashram_copy_bus.wdata;
+                    sdram_source_request <= SOURCE_FLASHRAM_COPY;
                 end else if (cfg_sdram_request) begin
                     sdram_mem_bus.write <= cfg_bus.write;
                     sdram_mem_bus.wmask <= cfg_bus.wmask;
@@ -89,6 +128,12 @@ module memory_arbiter (
                     sdram_mem_bus.address <= sd_dma_bus.address;
                     sdram_mem_bus.wdata <= sd_dma_bus.wdata;
                     sdram_source_request <= SOURCE_SD_DMA;
+                end else if (copy_sdram_request) begin
+                    sdram_mem_bus.write <= copy_bus.write;
+                    sdram_mem_bus.wmask <= copy_bus.wmask;
+                    sdram_mem_bus.address <= copy_bus.address;
+                    sdram_mem_bus.wdata <= copy_bus.wdata;
+                    sdram_source_request <= SOURCE_COPY;
                 end
             end
 
@@ -107,9 +152,12 @@ module memory_arbiter (
             if (!flash_mem_bus.request) begin
                 flash_mem_bus.request <= (
                     n64_flash_request ||
+                    dd_copy_flash_request ||
+                    flashram_copy_flash_request ||
                     cfg_flash_request ||
                     usb_dma_flash_request ||
-                    sd_dma_flash_request
+                    sd_dma_flash_request ||
+                    copy_flash_request
                 );
 
                 if (n64_flash_request) begin
@@ -118,6 +166,18 @@ module memory_arbiter (
                     flash_mem_bus.address <= n64_bus.address;
                     flash_mem_bus.wdata <= n64_bus.wdata;
                     flash_source_request <= SOURCE_N64;
+                end else if (dd_copy_flash_request) begin
+                    flash_mem_bus.write <= dd_copy_bus.write;
+                    flash_mem_bus.wmask <= dd_copy_bus.wmask;
+                    flash_mem_bus.address <= dd_copy_bus.address;
+                    flash_mem_bus.wdata <= dd_copy_bus.wdata;
+                    flash_source_request <= SOURCE_DD_COPY;
+                end else if (flashram_copy_flash_request) begin
+                    flash_mem_bus.write <= flashram_copy_bus.write;
+                    flash_mem_bus.wmask <= flashram_copy_bus.wmask;
+                    flash_mem_bus.address <= flashram_copy_bus.address;
+                    flash_mem_bus.wdata <= flashram_copy_bus.wdata;
+                    flash_source_request <= SOURCE_FLASHRAM_COPY;
                 end else if (cfg_flash_request) begin
                     flash_mem_bus.write <= cfg_bus.write;
                     flash_mem_bus.wmask <= cfg_bus.wmask;
@@ -136,6 +196,12 @@ module memory_arbiter (
                     flash_mem_bus.address <= sd_dma_bus.address;
                     flash_mem_bus.wdata <= sd_dma_bus.wdata;
                     flash_source_request <= SOURCE_SD_DMA;
+                end else if (copy_flash_request) begin
+                    flash_mem_bus.write <= copy_bus.write;
+                    flash_mem_bus.wmask <= copy_bus.wmask;
+                    flash_mem_bus.address <= copy_bus.address;
+                    flash_mem_bus.wdata <= copy_bus.wdata;
+                    flash_source_request <= SOURCE_COPY;
                 end
             end
 
@@ -154,9 +220,12 @@ module memory_arbiter (
             if (!bram_mem_bus.request) begin
                 bram_mem_bus.request <= (
                     n64_bram_request ||
+                    dd_copy_bram_request ||
+                    flashram_copy_bram_request ||
                     cfg_bram_request ||
                     usb_dma_bram_request ||
-                    sd_dma_bram_request
+                    sd_dma_bram_request ||
+                    copy_bram_request
                 );
 
                 if (n64_bram_request) begin
@@ -165,6 +234,18 @@ module memory_arbiter (
                     bram_mem_bus.address <= n64_bus.address;
                     bram_mem_bus.wdata <= n64_bus.wdata;
                     bram_source_request <= SOURCE_N64;
+                end else if (dd_copy_bram_request) begin
+                    bram_mem_bus.write <= dd_copy_bus.write;
+                    bram_mem_bus.wmask <= dd_copy_bus.wmask;
+                    bram_mem_bus.address <= dd_copy_bus.address;
+                    bram_mem_bus.wdata <= dd_copy_bus.wdata;
+                    bram_source_request <= SOURCE_DD_COPY;
+                end else if (flashram_copy_bram_request) begin
+                    bram_mem_bus.write <= flashram_copy_bus.write;
+                    bram_mem_bus.wmask <= flashram_copy_bus.wmask;
+                    bram_mem_bus.address <= flashram_copy_bus.address;
+                    bram_mem_bus.wdata <= flashram_copy_bus.wdata;
+                    bram_source_request <= SOURCE_FLASHRAM_COPY;
                 end else if (cfg_bram_request) begin
                     bram_mem_bus.write <= cfg_bus.write;
                     bram_mem_bus.wmask <= cfg_bus.wmask;
@@ -183,6 +264,12 @@ module memory_arbiter (
                     bram_mem_bus.address <= sd_dma_bus.address;
                     bram_mem_bus.wdata <= sd_dma_bus.wdata;
                     bram_source_request <= SOURCE_SD_DMA;
+                end else if (copy_bram_request) begin
+                    bram_mem_bus.write <= copy_bus.write;
+                    bram_mem_bus.wmask <= copy_bus.wmask;
+                    bram_mem_bus.address <= copy_bus.address;
+                    bram_mem_bus.wdata <= copy_bus.wdata;
+                    bram_source_request <= SOURCE_COPY;
                 end
             end
 
@@ -198,6 +285,16 @@ module memory_arbiter (
             ((flash_source_request == SOURCE_N64) && flash_mem_bus.ack) ||
             ((bram_source_request == SOURCE_N64) && bram_mem_bus.ack)
         );
+        dd_copy_bus.ack = (
+            ((sdram_source_request == SOURCE_DD_COPY) && sdram_mem_bus.ack) ||
+            ((flash_source_request == SOURCE_DD_COPY) && flash_mem_bus.ack) ||
+            ((bram_source_request == SOURCE_DD_COPY) && bram_mem_bus.ack)
+        );
+        flashram_copy_bus.ack = (
+            ((sdram_source_request == SOURCE_FLASHRAM_COPY) && sdram_mem_bus.ack) ||
+            ((flash_source_request == SOURCE_FLASHRAM_COPY) && flash_mem_bus.ack) ||
+            ((bram_source_request == SOURCE_FLASHRAM_COPY) && bram_mem_bus.ack)
+        );
         cfg_bus.ack = (
             ((sdram_source_request == SOURCE_CFG) && sdram_mem_bus.ack) ||
             ((flash_source_request == SOURCE_CFG) && flash_mem_bus.ack) ||
@@ -213,10 +310,21 @@ module memory_arbiter (
             ((flash_source_request == SOURCE_SD_DMA) && flash_mem_bus.ack) ||
             ((bram_source_request == SOURCE_SD_DMA) && bram_mem_bus.ack)
         );
+        copy_bus.ack = (
+            ((sdram_source_request == SOURCE_COPY) && sdram_mem_bus.ack) ||
+            ((flash_source_request == SOURCE_COPY) && flash_mem_bus.ack) ||
+            ((bram_source_request == SOURCE_COPY) && bram_mem_bus.ack)
+        );
 
         n64_bus.rdata = n64_bram_request ? bram_mem_bus.rdata :
             n64_flash_request ? flash_mem_bus.rdata :
             sdram_mem_bus.rdata;
+        dd_copy_bus.rdata = dd_copy_bram_request ? bram_mem_bus.rdata :
+            dd_copy_flash_request ? flash_mem_bus.rdata :
+            sdram_mem_bus.rdata;
+        flashram_copy_bus.rdata = flashram_copy_bram_request ? bram_mem_bus.rdata :
+            flashram_copy_flash_request ? flash_mem_bus.rdata :
+            sdram_mem_bus.rdata;
         cfg_bus.rdata = cfg_bram_request ? bram_mem_bus.rdata :
             cfg_flash_request ? flash_mem_bus.rdata :
             sdram_mem_bus.rdata;
@@ -226,6 +334,9 @@ module memory_arbiter (
         sd_dma_bus.rdata = sd_dma_bram_request ? bram_mem_bus.rdata :
             sd_dma_flash_request ? flash_mem_bus.rdata :
             sdram_mem_bus.rdata;
+        copy_bus.rdata = copy_bram_request ? bram_mem_bus.rdata :
+            copy_flash_request ? flash_mem_bus.rdata :
+            sdram_mem_bus.rdata;
     end
 
 endmodule
@@ -0,0 +1,151 @@
+interface copy_scb ();
+
+    logic start;
+    logic stop;
+    logic busy;
+    logic fill;
+    logic [15:0] fill_data;
+    logic crc32;
+    logic [31:0] crc32_result;
+    logic [26:0] source_address;
+    logic [26:0] destination_address;
+    logic [26:0] transfer_length;
+
+    modport controller (
+        output start,
+        output stop,
+        input busy,
+        output fill,
+        output fill_data,
+        output crc32,
+        input crc32_result,
+        output source_address,
+        output destination_address,
+        output transfer_length
+    );
+
+    modport copy (
+        input start,
+        input stop,
+        output busy,
+        input fill,
+        input fill_data,
+        input crc32,
+        output crc32_result,
+        input source_address,
+        input destination_address,
+        input transfer_length
+    );
+
+endinterface
+
+
+module memory_copy (
+    input clk,
+    input reset,
+
+    copy_scb.copy copy_scb,
+
+    mem_bus.controller mem_bus
+);
+
+    typedef enum bit [0:0] {
+        STATE_READ,
+        STATE_WRITE
+    } e_state;
+
+    e_state state;
+
+    logic fill;
+    logic crc32;
+    logic odd_length;
+    logic [26:0] source_address;
+    logic [26:0] destination_address;
+    logic [26:0] remaining;
+
+
+    // Copy start/stop control
+
+    logic copy_start;
+    logic copy_stop;
+
+    always_comb begin
+        copy_start = copy_scb.start && !copy_scb.stop && !copy_scb.busy;
+        copy_stop = copy_scb.stop;
+    end
+
+    always_ff @(posedge clk) begin
+        copy_scb.busy <= mem_bus.request || (remaining > 27'd0);
+    end
+
+
+    // Mem bus controller
+
+    always_comb begin
+        mem_bus.wmask = 2'b11;
+    end
+
+    always_ff @(posedge clk) begin
+        if (reset || copy_stop) begin
+            remaining <= 27'd0;
+        end else if (copy_start) begin
+            state <= copy_scb.fill ? STATE_WRITE : STATE_READ;
+            fill <= copy_scb.fill;
+            crc32 <= copy_scb.crc32;
+            odd_length <= copy_scb.transfer_length[0];
+            source_address <= {copy_scb.source_address[26:1], 1'b0};
+            destination_address <= {copy_scb.destination_address[26:1], 1'b0};
+            remaining <= copy_scb.transfer_length[26:1] + copy_scb.transfer_length[0];
+        end
+
+        if (reset) begin
+            mem_bus.request <= 1'b0;
+        end else begin
+            if (copy_start && copy_scb.fill) begin
+                mem_bus.wdata <= copy_scb.fill_data;
+            end
+
+            if (!mem_bus.request && !copy_stop && (remaining > 27'd0)) begin
+                mem_bus.request <= 1'b1;
+                mem_bus.write <= (state == STATE_WRITE);
+                mem_bus.address <= (state == STATE_WRITE) ? destination_address : source_address;
+            end
+
+            if (mem_bus.ack) begin
+                mem_bus.request <= 1'b0;
+                if (state == STATE_READ) begin
+                    source_address <= source_address + 2'd2;
+                    if (crc32) begin
+                        if (!copy_stop && (remaining > 27'd0)) begin
+                            remaining <= remaining - 1'd1;
+                        end
+                    end else begin
+                        state <= STATE_WRITE;
+                        mem_bus.wdata <= mem_bus.rdata;
+                    end
+                end else begin
+                    state <= fill ? STATE_WRITE : STATE_READ;
+                    destination_address <= destination_address + 2'd2;
+                    if (!copy_stop && (remaining > 27'd0)) begin
+                        remaining <= remaining - 1'd1;
+                    end
+                end
+            end
+        end
+    end
+
+
+    // CRC32 calculation
+
+    memory_crc32 memory_crc32_inst (
+        .clk(clk),
+        .reset(reset || (copy_start && copy_scb.crc32)),
+
+        .enable(crc32 && (state == STATE_READ) && mem_bus.ack),
+        .upper_only(odd_length && (remaining == 27'd1)),
+        .data(mem_bus.rdata),
+
+        .result(copy_scb.crc32_result)
+    );
+
+endmodule
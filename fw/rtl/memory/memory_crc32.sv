@@ -0,0 +1,36 @@
+module memory_crc32 (
+    input clk,
+    input reset,
+
+    input enable,
+    input upper_only,
+    input [15:0] data,
+
+    output logic [31:0] result
+);
+
+    logic [31:0] crc;
+    logic [31:0] crc_next;
+
+    always_comb begin
+        crc_next = crc;
+        for (int i = 0; i < 16; i++) begin
+            if ((i < 8) || !upper_only) begin
+                crc_next = {1'b0, crc_next[31:1]} ^ ((crc_next[0] ^ data[(i < 8) ? (i + 8) : (i - 8)]) ? 32'hEDB88320 : 32'd0);
+            end
+        end
+    end
+
+    always_comb begin
+        result = ~crc;
+    end
+
+    always_ff @(posedge clk) begin
+        if (reset) begin
+            crc <= 32'hFFFFFFFF;
+        end else if (enable) begin
+            crc <= crc_next;
+        end
+    end
+
+endmodule
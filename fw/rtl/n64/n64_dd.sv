@@ -18,6 +18,8 @@ interface dd_scb ();
     logic [7:0] sector_size;
     logic [7:0] sector_size_full;
     logic [7:0] sectors_in_block;
+    logic block_active;
+    logic [7:0] block_sector;
 
 
     // CPU controlled regs
@@ -37,6 +39,12 @@ interface dd_scb ();
     logic index_lock;
     logic [12:0] head_track;
     logic [15:0] drive_id;
+    logic block_start;
+    logic block_stop;
+    logic block_write;
+    logic [26:0] block_address;
+    logic [7:0] block_sector_size;
+    logic [7:0] block_sectors;
 
     modport controller (
         input hard_reset,
@@ -53,6 +61,8 @@ interface dd_scb ();
         input sector_size,
         input sector_size_full,
         input sectors_in_block,
+        input block_active,
+        input block_sector,
 
         output hard_reset_clear,
         output cmd_data,
@@ -68,7 +78,13 @@ interface dd_scb ();
         output disk_changed,
         output index_lock,
         output head_track,
-        output drive_id
+        output drive_id,
+        output block_start,
+        output block_stop,
+        output block_write,
+        output block_address,
+        output block_sector_size,
+        output block_sectors
     );
 
     modport dd (
@@ -88,6 +104,8 @@ interface dd_scb ();
         output sector_size,
         output sector_size_full,
         output sectors_in_block,
+        output block_active,
+        output block_sector,
 
         input hard_reset_clear,
         input cmd_data,
@@ -103,7 +121,13 @@ interface dd_scb ();
         input disk_changed,
         input index_lock,
         input head_track,
-        input drive_id
+        input drive_id,
+        input block_start,
+        input block_stop,
+        input block_write,
+        input block_address,
+        input block_sector_size,
+        input block_sectors
     );
 
 endinterface
@@ -117,6 +141,7 @@ module n64_dd (
 
     n64_scb.dd n64_scb,
     dd_scb.dd dd_scb,
+    copy_scb.controller copy_scb,
 
     output logic irq
 );
@@ -124,6 +149,8 @@ module n64_dd (
     const bit [10:0] MEM_C2_BUFFER      = 11'h000;
     const bit [10:0] MEM_SECTOR_BUFFER  = 11'h400;
 
+    const bit [26:0] SECTOR_BUFFER_ADDRESS = 27'h5002800;
+
     typedef enum bit [10:0] {
         REG_DATA        = 11'h500,
         REG_CMD_SR      = 11'h508,
@@ -175,6 +202,25 @@ module n64_dd (
         end
     end
 
+    logic sector_buffer_done;
+    logic block_reset;
+    logic stream_ready;
+    logic stream_pending;
+
+    always_comb begin
+        sector_buffer_done = (
+            (reg_bus.address[10:0] == (MEM_SECTOR_BUFFER + {dd_scb.sector_size[7:1], 1'b0})) &&
+            (reg_bus.read || reg_bus.write)
+        );
+        block_reset = (
+            reset ||
+            n64_scb.n64_reset ||
+            dd_scb.block_stop ||
+            (reg_bus.write && (reg_bus.address[10:0] == REG_BM_SCR) && reg_bus.wdata[BM_CONTROL_BUFFER_MANAGER_RESET]) ||
+            (reg_bus.write && (reg_bus.address[10:0] == REG_RESET) && (reg_bus.wdata == 16'hAAAA))
+        );
+    end
+
     always_ff @(posedge clk) begin
         dd_scb.bm_interrupt_ack <= 1'b0;
 
@@ -195,18 +241,21 @@ module n64_dd (
         if (dd_scb.bm_clear) begin
             dd_scb.bm_pending <= 1'b0;
         end
-        if (dd_scb.bm_ready) begin
+        if (dd_scb.bm_ready || stream_ready) begin
             dd_scb.bm_interrupt <= 1'b1;
         end
+        if (stream_pending) begin
+            dd_scb.bm_pending <= 1'b1;
+        end
         if (reg_bus.address[10:0] == (MEM_C2_BUFFER + ({dd_scb.sector_size[7:1], 1'b0} * 3'd4)) && reg_bus.read) begin
             dd_scb.bm_pending <= 1'b1;
         end
-        if (reg_bus.address[10:0] == (MEM_SECTOR_BUFFER + {dd_scb.sector_size[7:1], 1'b0}) && (reg_bus.read || reg_bus.write)) begin
+        if (sector_buffer_done && !dd_scb.block_active) begin
             dd_scb.bm_pending <= 1'b1;
         end
         if (reg_bus.address[10:0] == REG_CMD_SR && reg_bus.read) begin
             dd_scb.bm_interrupt <= 1'b0;
-            dd_scb.bm_interrupt_ack <= 1'b1;
+            dd_scb.bm_interrupt_ack <= !dd_scb.block_active;
         end
 
         if (reset || n64_scb.n64_reset) begin
@@ -277,6 +326,97 @@ module n64_dd (
         irq = dd_scb.cmd_interrupt || dd_scb.bm_interrupt;
     end
 
+
+    // Block buffer sector streaming
+
+    typedef enum bit [1:0] {
+        STREAM_IDLE,
+        STREAM_COPY,
+        STREAM_WAIT_BUSY,
+        STREAM_WAIT_DONE
+    } e_stream_state;
+
+    e_stream_state stream_state;
+
+    logic block_write;
+    logic [26:0] block_address;
+    logic [7:0] block_sector_size;
+    logic [7:0] block_sectors;
+    logic block_last_sector;
+
+    always_comb begin
+        block_last_sector = ((dd_scb.block_sector + 1'd1) >= block_sectors);
+    end
+
+    always_comb begin
+        copy_scb.stop = 1'b0;
+        copy_scb.fill = 1'b0;
+        copy_scb.fill_data = 16'd0;
+        copy_scb.crc32 = 1'b0;
+        copy_scb.source_address = block_write ? SECTOR_BUFFER_ADDRESS : block_address;
+        copy_scb.destination_address = block_write ? block_address : SECTOR_BUFFER_ADDRESS;
+        copy_scb.transfer_length = {19'd0, block_sector_size} + 1'd1;
+    end
+
+    always_ff @(posedge clk) begin
+        copy_scb.start <= 1'b0;
+        stream_ready <= 1'b0;
+        stream_pending <= 1'b0;
+
+        if (block_reset) begin
+            dd_scb.block_active <= 1'b0;
+            stream_state <= STREAM_IDLE;
+        end else if (dd_scb.block_start) begin
+            dd_scb.block_active <= 1'b1;
+            dd_scb.block_sector <= 8'd0;
+            block_write <= dd_scb.block_write;
+            block_address <= dd_scb.block_address;
+            block_sector_size <= dd_scb.block_sector_size;
+            block_sectors <= dd_scb.block_sectors;
+            stream_state <= dd_scb.block_write ? STREAM_IDLE : STREAM_COPY;
+        end else begin
+            case (stream_state)
+                STREAM_IDLE: begin
+                    if (dd_scb.block_active && sector_buffer_done) begin
+                        if (!block_write && (dd_scb.block_sector >= block_sectors)) begin
+                            dd_scb.block_active <= 1'b0;
+                            stream_pending <= 1'b1;
+                        end else begin
+                            stream_state <= STREAM_COPY;
+                        end
+                    end
+                end
+
+                STREAM_COPY: begin
+                    if (!copy_scb.busy) begin
+                        copy_scb.start <= 1'b1;
+                        stream_state <= STREAM_WAIT_BUSY;
+                    end
+                end
+
+                STREAM_WAIT_BUSY: begin
+                    if (copy_scb.busy) begin
+                        stream_state <= STREAM_WAIT_DONE;
+                    end
+                end
+
+                STREAM_WAIT_DONE: begin
+                    if (!copy_scb.busy) begin
+                        stream_state <= STREAM_IDLE;
+                        dd_scb.block_sector <= dd_scb.block_sector + 1'd1;
+                        block_address <= block_address + block_sector_size + 1'd1;
+                        if (block_write && block_last_sector) begin
+                            dd_scb.block_active <= 1'b0;
+                            stream_pending <= 1'b1;
+                        end else begin
+                            stream_ready <= 1'b1;
+                        end
+                    end
+                end
+            endcase
+        end
+    end
+
     always_comb begin
         n64_scb.dd_write = reg_bus.write && reg_bus.address[10:8] == MEM_SECTOR_BUFFER[10:8];
         n64_scb.dd_address = reg_bus.address[7:1];
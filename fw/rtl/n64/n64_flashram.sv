@@ -4,12 +4,19 @@ module n64_flashram (
 
     n64_reg_bus.flashram reg_bus,
 
-    n64_scb.flashram n64_scb
+    n64_scb.flashram n64_scb,
+    copy_scb.controller copy_scb
 );
 
     localparam [31:0] FLASH_TYPE_ID     = 32'h1111_8001;
     localparam [31:0] FLASH_MODEL_ID    = 32'h00C2_001D;
 
+    const bit [26:0] SAVE_ADDRESS       = 27'h3FE0000;
+    const bit [26:0] BUFFER_ADDRESS     = 27'h5002900;
+    const bit [26:0] PAGE_SIZE          = 27'd128;
+    const bit [26:0] SECTOR_SIZE        = 27'd16384;
+    const bit [26:0] CHIP_SIZE          = 27'd131072;
+
     typedef enum bit [7:0] {
         CMD_STATUS_MODE     = 8'hD2,
         CMD_READID_MODE     = 8'hE1,
@@ -143,6 +150,69 @@ module n64_flashram (
         end
     end
 
+
+
+    // Save memory program and erase
+
+    typedef enum bit [1:0] {
+        OP_IDLE,
+        OP_START,
+        OP_WAIT_BUSY,
+        OP_WAIT_DONE
+    } e_op_state;
+
+    e_op_state op_state;
+
+    always_comb begin
+        copy_scb.stop = 1'b0;
+        copy_scb.fill = n64_scb.flashram_write_or_erase;
+        copy_scb.fill_data = 16'hFFFF;
+        copy_scb.crc32 = 1'b0;
+        copy_scb.source_address = BUFFER_ADDRESS;
+        copy_scb.destination_address = SAVE_ADDRESS + {10'd0, n64_scb.flashram_sector, 7'd0};
+        copy_scb.transfer_length = PAGE_SIZE;
+        if (n64_scb.flashram_write_or_erase) begin
+            copy_scb.transfer_length = n64_scb.flashram_sector_or_all ? CHIP_SIZE : SECTOR_SIZE;
+        end
+    end
+
+    always_ff @(posedge clk) begin
+        copy_scb.start <= 1'b0;
+        n64_scb.flashram_done <= 1'b0;
+
+        if (reset) begin
+            op_state <= OP_IDLE;
+        end else begin
+            case (op_state)
+                OP_IDLE: begin
+                    if (n64_scb.flashram_pending && !n64_scb.flashram_done) begin
+                        op_state <= OP_START;
+                    end
+                end
+
+                OP_START: begin
+                    if (!copy_scb.busy) begin
+                        copy_scb.start <= 1'b1;
+                        op_state <= OP_WAIT_BUSY;
+                    end
+                end
+
+                OP_WAIT_BUSY: begin
+                    if (copy_scb.busy) begin
+                        op_state <= OP_WAIT_DONE;
+                    end
+                end
+
+                OP_WAIT_DONE: begin
+                    if (!copy_scb.busy) begin
+                        n64_scb.flashram_done <= 1'b1;
+                        op_state <= OP_IDLE;
+                    end
+                end
+            endcase
+        end
+    end
+
     always_comb begin
         n64_scb.flashram_write = reg_bus.write && !reg_bus.address[16] && state == STATE_BUFFER;
         n64_scb.flashram_address = reg_bus.address[6:1];
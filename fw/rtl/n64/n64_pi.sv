@@ -415,6 +415,7 @@ module n64_pi (
         write_fifo_read <= 1'b0;
         load_starting_address <= 1'b0;
         n64_scb.sram_done <= 1'b0;
+        n64_scb.sram_write <= 1'b0;
 
         if (reset || !pi_reset) begin
             mem_bus.request <= 1'b0;
@@ -455,6 +456,10 @@ module n64_pi (
             if (mem_bus.ack) begin
                 mem_bus.request <= 1'b0;
                 mem_bus.address[16:0] <= mem_bus.address[16:0] + 2'd2;
+                if (mem_bus.write && sram_selected) begin
+                    n64_scb.sram_write <= 1'b1;
+                    n64_scb.sram_sector <= mem_bus.address[16:9];
+                end
             end
 
             if (end_op) begin
@@ -21,4 +21,52 @@ module n64_save_counter (
         n64_scb.save_count <= counter;
     end
 
+
+    // Dirty 512 byte save sectors
+
+    logic [255:0] dirty;
+    logic [255:0] dirty_set;
+    logic [255:0] dirty_clear;
+
+    always_comb begin
+        dirty_set = 256'd0;
+        dirty_clear = 256'd0;
+
+        if (n64_scb.eeprom_write) begin
+            dirty_set[{6'd0, n64_scb.eeprom_address[10:9]}] = 1'b1;
+        end
+
+        if (n64_scb.sram_write) begin
+            dirty_set[n64_scb.sram_sector] = 1'b1;
+        end
+
+        if (n64_scb.flashram_done) begin
+            if (n64_scb.flashram_write_or_erase) begin
+                if (n64_scb.flashram_sector_or_all) begin
+                    dirty_set = {256{1'b1}};
+                end else begin
+                    dirty_set[{n64_scb.flashram_sector[9:7], 5'd0} +: 32] = {32{1'b1}};
+                end
+            end else begin
+                dirty_set[n64_scb.flashram_sector[9:2]] = 1'b1;
+            end
+        end
+
+        if (n64_scb.save_dirty_clear) begin
+            dirty_clear[{n64_scb.save_dirty_clear_word, 5'd0} +: 32] = n64_scb.save_dirty_clear_mask;
+        end
+    end
+
+    always_ff @(posedge clk) begin
+        if (reset) begin
+            dirty <= 256'd0;
+        end else begin
+            dirty <= (dirty & ~dirty_clear) | dirty_set;
+        end
+    end
+
+    always_comb begin
+        n64_scb.save_dirty = dirty;
+    end
+
 endmodule
@@ -31,6 +31,8 @@ interface n64_scb ();
     logic [15:0] flashram_wdata;
 
     logic sram_done;
+    logic sram_write;
+    logic [7:0] sram_sector;
 
     logic eeprom_write;
     logic [10:0] eeprom_address;
@@ -54,6 +56,10 @@ interface n64_scb ();
     logic [31:0] cfg_identifier;
 
     logic [15:0] save_count;
+    logic [255:0] save_dirty;
+    logic save_dirty_clear;
+    logic [2:0] save_dirty_clear_word;
+    logic [31:0] save_dirty_clear_mask;
 
     logic pi_sdram_active;
     logic pi_flash_active;
@@ -76,7 +82,6 @@ interface n64_scb ();
         output eeprom_16k_mode,
 
         input flashram_pending,
-        output flashram_done,
         input flashram_sector,
         input flashram_sector_or_all,
         input flashram_write_or_erase,
@@ -97,6 +102,10 @@ interface n64_scb ();
         output cfg_identifier,
 
         input save_count,
+        input save_dirty,
+        output save_dirty_clear,
+        output save_dirty_clear_word,
+        output save_dirty_clear_mask,
 
         input pi_debug
     );
@@ -116,6 +125,8 @@ interface n64_scb ();
         input ddipl_enabled,
 
         output sram_done,
+        output sram_write,
+        output sram_sector,
 
         input flashram_read_mode,
 
@@ -128,7 +139,7 @@ interface n64_scb ();
 
     modport flashram (
         output flashram_pending,
-        input flashram_done,
+        output flashram_done,
         output flashram_sector,
         output flashram_sector_or_all,
         output flashram_write_or_erase,
@@ -199,10 +210,20 @@ interface n64_scb ();
 
     modport save_counter (
         input eeprom_write,
+        input eeprom_address,
         input sram_done,
+        input sram_write,
+        input sram_sector,
         input flashram_done,
+        input flashram_sector,
+        input flashram_sector_or_all,
+        input flashram_write_or_erase,
 
-        output save_count
+        output save_count,
+        output save_dirty,
+        input save_dirty_clear,
+        input save_dirty_clear_word,
+        input save_dirty_clear_mask
     );
 
     modport arbiter (
@@ -4,6 +4,8 @@ module n64_top (
 
     n64_scb n64_scb,
     dd_scb.dd dd_scb,
+    copy_scb.controller dd_copy_scb,
+    copy_scb.controller flashram_copy_scb,
 
     mem_bus.controller mem_bus,
 
@@ -59,6 +61,7 @@ module n64_top (
 
         .n64_scb(n64_scb),
         .dd_scb(dd_scb),
+        .copy_scb(dd_copy_scb),
 
         .irq(n64_dd_irq)
     );
@@ -69,7 +72,8 @@ module n64_top (
 
         .reg_bus(reg_bus),
 
-        .n64_scb(n64_scb)
+        .n64_scb(n64_scb),
+        .copy_scb(flashram_copy_scb)
     );
 
     n64_cfg n64_cfg_inst (
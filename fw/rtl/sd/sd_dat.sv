@@ -295,6 +295,9 @@ module sd_dat (
                             if ((blocks_remaining > 8'd0) && (sd_scb.rx_count > 11'd512)) begin
                                 sd_scb.clock_stop <= 1'b1;
                             end
+                            if ((blocks_remaining == 8'd0) && sd_scb.dat_stream) begin
+                                sd_scb.clock_stop <= 1'b1;
+                            end
                             blocks_remaining <= blocks_remaining - 1'd1;
                         end
                     end
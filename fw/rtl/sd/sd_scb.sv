@@ -24,6 +24,7 @@ interface sd_scb ();
     logic dat_start_read;
     logic dat_stop;
     logic [7:0] dat_blocks;
+    logic dat_stream;
     logic dat_busy;
     logic dat_error;
 
@@ -51,6 +52,7 @@ interface sd_scb ();
         output dat_start_read,
         output dat_stop,
         output dat_blocks,
+        output dat_stream,
         input dat_busy,
         input dat_error
     );
@@ -86,6 +88,7 @@ interface sd_scb ();
         input dat_start_read,
         input dat_stop,
         input dat_blocks,
+        input dat_stream,
         output dat_busy,
         output dat_error
     );
@@ -57,6 +57,9 @@ module top (
     dma_scb usb_dma_scb ();
     sd_scb sd_scb ();
     dma_scb sd_dma_scb ();
+    copy_scb copy_scb ();
+    copy_scb dd_copy_scb ();
+    copy_scb flashram_copy_scb ();
     flash_scb flash_scb ();
     vendor_scb vendor_scb ();
 
@@ -66,9 +69,12 @@ module top (
     fifo_bus sd_fifo_bus ();
 
     mem_bus n64_mem_bus ();
+    mem_bus dd_copy_mem_bus ();
+    mem_bus flashram_copy_mem_bus ();
     mem_bus cfg_mem_bus ();
     mem_bus usb_dma_mem_bus ();
     mem_bus sd_dma_mem_bus ();
+    mem_bus copy_mem_bus ();
     mem_bus sdram_mem_bus ();
     mem_bus flash_mem_bus ();
     mem_bus bram_mem_bus ();
@@ -93,6 +99,7 @@ module top (
         .usb_dma_scb(usb_dma_scb),
         .sd_scb(sd_scb),
         .sd_dma_scb(sd_dma_scb),
+        .copy_scb(copy_scb),
         .flash_scb(flash_scb),
         .vendor_scb(vendor_scb),
 
@@ -118,6 +125,8 @@ module top (
 
         .n64_scb(n64_scb),
         .dd_scb(dd_scb),
+        .dd_copy_scb(dd_copy_scb),
+        .flashram_copy_scb(flashram_copy_scb),
 
         .mem_bus(n64_mem_bus),
 
@@ -196,6 +205,36 @@ module top (
     );
 
 
+    // Memory copy engines
+
+    memory_copy memory_copy_inst (
+        .clk(clk),
+        .reset(reset),
+
+        .copy_scb(copy_scb),
+
+        .mem_bus(copy_mem_bus)
+    );
+
+    memory_copy dd_copy_inst (
+        .clk(clk),
+        .reset(reset),
+
+        .copy_scb(dd_copy_scb),
+
+        .mem_bus(dd_copy_mem_bus)
+    );
+
+    memory_copy flashram_copy_inst (
+        .clk(clk),
+        .reset(reset),
+
+        .copy_scb(flashram_copy_scb),
+
+        .mem_bus(flashram_copy_mem_bus)
+    );
+
+
     // Memory bus arbiter
 
     memory_arbiter memory_arbiter_inst (
@@ -205,9 +244,12 @@ module top (
         .n64_scb(n64_scb),
 
         .n64_bus(n64_mem_bus),
+        .dd_copy_bus(dd_copy_mem_bus),
+        .flashram_copy_bus(flashram_copy_mem_bus),
         .cfg_bus(cfg_mem_bus),
         .usb_dma_bus(usb_dma_mem_bus),
         .sd_dma_bus(sd_dma_mem_bus),
+        .copy_bus(copy_mem_bus),
 
         .sdram_mem_bus(sdram_mem_bus),
         .flash_mem_bus(flash_mem_bus),
@@ -7,6 +7,8 @@
 
 #define SD_SECTOR_SIZE      (512)
 #define BUFFER_BLOCKS_MAX   (sizeof(SC64_BUFFERS->BUFFER) / SD_SECTOR_SIZE)
+#define PIPELINE_BLOCKS     (BUFFER_BLOCKS_MAX / 2)
+#define PIPELINE_BUFFER(n)  ((uint32_t *) (&SC64_BUFFERS->BUFFER[(n) * PIPELINE_BLOCKS * SD_SECTOR_SIZE]))
 
 
 DSTATUS disk_status (BYTE pdrv) {
@@ -43,22 +45,31 @@ DRESULT disk_read (BYTE pdrv, BYTE *buff, LBA_t sector, UINT count) {
     }
     uint32_t *physical_address = (uint32_t *) (PHYSICAL(buff));
     if (physical_address < (uint32_t *) (N64_RAM_SIZE)) {
-        uint8_t aligned_buffer[BUFFER_BLOCKS_MAX * SD_SECTOR_SIZE] __attribute__((aligned(8)));
+        uint8_t aligned_buffer[PIPELINE_BLOCKS * SD_SECTOR_SIZE] __attribute__((aligned(8)));
+        int current = 0;
+        uint32_t blocks = ((count > PIPELINE_BLOCKS) ? PIPELINE_BLOCKS : count);
+        if (sc64_sd_read_sectors_start(PIPELINE_BUFFER(current), sector, blocks)) {
+            return RES_ERROR;
+        }
         while (count > 0) {
-            uint32_t blocks = ((count > BUFFER_BLOCKS_MAX) ? BUFFER_BLOCKS_MAX : count);
-            size_t length = (blocks * SD_SECTOR_SIZE);
-            if (sc64_sd_read_sectors((uint32_t *) (SC64_BUFFERS->BUFFER), sector, blocks)) {
+            if (sc64_sd_read_wait()) {
                 return RES_ERROR;
             }
+            count -= blocks;
+            uint32_t next_blocks = ((count > PIPELINE_BLOCKS) ? PIPELINE_BLOCKS : count);
+            if (next_blocks > 0) {
+                sc64_sd_read_sectors_next(PIPELINE_BUFFER(current ^ 1), next_blocks);
+            }
+            size_t length = (blocks * SD_SECTOR_SIZE);
             if (((uint32_t) (buff) % 8) == 0) {
-                pi_dma_read((io32_t *) (SC64_BUFFERS->BUFFER), buff, length);
+                pi_dma_read((io32_t *) (PIPELINE_BUFFER(current)), buff, length);
             } else {
-                pi_dma_read((io32_t *) (SC64_BUFFERS->BUFFER), aligned_buffer, length);
+                pi_dma_read((io32_t *) (PIPELINE_BUFFER(current)), aligned_buffer, length);
                 memcpy(buff, aligned_buffer, length);
             }
             buff += length;
-            sector += blocks;
-            count -= blocks;
+            blocks = next_blocks;
+            current ^= 1;
         }
     } else {
         if (sc64_sd_read_sectors(physical_address, sector, count)) {
@@ -26,6 +26,15 @@ void cache_inst_hit_invalidate (void *address, size_t length) {
     cache_operation(HIT_INVALIDATE_I, CACHE_LINE_SIZE_I, address, length);
 }
 
+uint32_t cpu_count_read (void) {
+    uint32_t count;
+    asm volatile (
+        "mfc0 %[count], $9 \n" :
+        [count] "=r" (count)
+    );
+    return count;
+}
+
 uint32_t cpu_io_read (io32_t *address) {
     io32_t *uncached = UNCACHED(address);
     uint32_t value = *uncached;
@@ -17,6 +17,8 @@ typedef volatile uint32_t io32_t;
 
 #define N64_RAM_SIZE                (0x00800000UL)
 
+#define CPU_COUNT_FREQUENCY         (46875000UL)
+
 #define FROM_BCD(x)                 ((((x >> 4) & 0x0F) * 10) + (x & 0x0F))
 
 
@@ -254,6 +256,7 @@ typedef struct {
 #define OS_INFO_RESET_TYPE_NMI      (1)
 
 
+uint32_t cpu_count_read (void);
 uint32_t cpu_io_read (io32_t *address);
 void cpu_io_write (io32_t *address, uint32_t value);
 uint32_t pi_busy (void);
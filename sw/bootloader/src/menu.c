@@ -1,8 +1,10 @@
 #include "error.h"
 #include "fatfs/ff.h"
+#include "fatfs/diskio.h"
 #include "init.h"
 #include "io.h"
 #include "menu.h"
+#include "sc64.h"
 
 
 extern const void __bootloader_start __attribute__((section(".data")));
@@ -12,6 +14,21 @@ extern const void __bootloader_end __attribute__((section(".data")));
 #define ROM_ENTRY_OFFSET    (8)
 #define ROM_CODE_OFFSET     (4096)
 #define ROM_MAX_LOAD_SIZE   (1 * 1024 * 1024)
+#define ROM_SCRATCH_ADDRESS (0x13A00000UL)
+#define ROM_SECTOR_SIZE     (512)
+
+#define MENU_FILE_NAME      "sc64menu.n64"
+#define MENU_CLMT_SIZE      (64)
+#define MENU_CACHE_RUNS     (4)
+
+
+typedef struct {
+    uint32_t volbase;
+    uint32_t sclust;
+    uint32_t size;
+    uint32_t timestamp;
+    uint32_t runs[MENU_CACHE_RUNS][2];
+} menu_cache_t;
 
 
 static const char *fatfs_error_codes[] = {
@@ -63,17 +80,131 @@ static void menu_check_load_address (void *address, size_t size) {
     }
 }
 
+static void menu_cache_read (menu_cache_t *cache) {
+    uint32_t *words = (uint32_t *) (cache);
+    for (int i = 0; i < (sizeof(menu_cache_t) / sizeof(uint32_t)); i++) {
+        words[i] = sc64_get_setting((sc64_setting_id_t) (SETTING_ID_MENU_CACHE + i));
+    }
+}
+
+static void menu_cache_write (menu_cache_t *cache, menu_cache_t *stored) {
+    uint32_t *words = (uint32_t *) (cache);
+    uint32_t *stored_words = (uint32_t *) (stored);
+    for (int i = 0; i < (sizeof(menu_cache_t) / sizeof(uint32_t)); i++) {
+        if (words[i] != stored_words[i]) {
+            sc64_set_setting((sc64_setting_id_t) (SETTING_ID_MENU_CACHE + i), words[i]);
+        }
+    }
+}
+
+static bool menu_cache_restore (FATFS *fs, menu_cache_t *cache, DWORD *clmt) {
+    DWORD *tbl = &clmt[1];
+    FSIZE_t mapped_size = 0;
+
+    for (int i = 0; i < MENU_CACHE_RUNS; i++) {
+        if (cache->runs[i][0] == 0) {
+            break;
+        }
+        *tbl++ = cache->runs[i][0];
+        *tbl++ = cache->runs[i][1];
+        mapped_size += ((FSIZE_t) (cache->runs[i][0]) * fs->csize * ROM_SECTOR_SIZE);
+    }
+    *tbl++ = 0;
+    clmt[0] = (tbl - clmt);
+
+    return (mapped_size < cache->size);
+}
+
+static void menu_setup_fast_seek (FATFS *fs, FIL *fil, FILINFO *fno, DWORD *clmt) {
+    menu_cache_t stored;
+    menu_cache_t cache = {
+        .volbase = fs->volbase,
+        .sclust = fil->obj.sclust,
+        .size = (uint32_t) (fno->fsize),
+        .timestamp = ((fno->fdate << 16) | fno->ftime),
+    };
+
+    menu_cache_read(&stored);
+
+    if (
+        (stored.size != 0) &&
+        (stored.volbase == cache.volbase) &&
+        (stored.sclust == cache.sclust) &&
+        (stored.size == cache.size) &&
+        (stored.timestamp == cache.timestamp)
+    ) {
+        if (!menu_cache_restore(fs, &stored, clmt)) {
+            fil->cltbl = clmt;
+            return;
+        }
+    }
+
+    clmt[0] = MENU_CLMT_SIZE;
+    fil->cltbl = clmt;
+
+    if (f_lseek(fil, CREATE_LINKMAP) != FR_OK) {
+        fil->cltbl = NULL;
+        return;
+    }
+
+    DWORD runs = ((clmt[0] - 2) / 2);
+
+    if ((runs == 0) || (runs > MENU_CACHE_RUNS)) {
+        cache.size = 0;
+    } else {
+        for (int i = 0; i < runs; i++) {
+            cache.runs[i][0] = clmt[1 + (i * 2)];
+            cache.runs[i][1] = clmt[2 + (i * 2)];
+        }
+    }
+
+    menu_cache_write(&cache, &stored);
+}
+
+static bool menu_read_runs (FATFS *fs, DWORD *clmt, FSIZE_t offset, void *buffer, size_t length) {
+    DWORD *tbl = &clmt[1];
+    FSIZE_t cluster_size = ((FSIZE_t) (fs->csize) * ROM_SECTOR_SIZE);
+
+    while (length > 0) {
+        DWORD clusters = *tbl++;
+        if (clusters == 0) {
+            return true;
+        }
+        DWORD cluster = *tbl++;
+        FSIZE_t run_size = (clusters * cluster_size);
+        if (offset >= run_size) {
+            offset -= run_size;
+            continue;
+        }
+        size_t chunk = (((run_size - offset) < length) ? (size_t) (run_size - offset) : length);
+        LBA_t sector = (fs->database + ((LBA_t) (cluster - 2) * fs->csize) + (LBA_t) (offset / ROM_SECTOR_SIZE));
+        if (disk_read(fs->pdrv, buffer, sector, (chunk / ROM_SECTOR_SIZE)) != RES_OK) {
+            return true;
+        }
+        buffer += chunk;
+        length -= chunk;
+        offset = 0;
+    }
+
+    return false;
+}
+
 
 void menu_load_and_run (void) {
     void (* menu)(void);
     FRESULT fresult;
     FATFS fs;
     FIL fil;
+    FILINFO fno;
     UINT br;
+    DWORD clmt[MENU_CLMT_SIZE];
     size_t size = ROM_MAX_LOAD_SIZE;
+    size_t direct_size;
 
     FF_CHECK(f_mount(&fs, "", 1), "Couldn't mount drive");
-    FF_CHECK(f_open(&fil, "sc64menu.n64", FA_READ), "Couldn't open menu file");
+    FF_CHECK(f_stat(MENU_FILE_NAME, &fno), "Couldn't find menu file");
+    FF_CHECK(f_open(&fil, MENU_FILE_NAME, FA_READ), "Couldn't open menu file");
+    menu_setup_fast_seek(&fs, &fil, &fno, clmt);
     FF_CHECK(f_lseek(&fil, ROM_ENTRY_OFFSET), "Couldn't seek to entry point offset");
     FF_CHECK(f_read(&fil, &menu, sizeof(menu), &br), "Couldn't read entry point");
     FF_CHECK(f_lseek(&fil, ROM_CODE_OFFSET), "Couldn't seek to code start offset");
@@ -83,8 +214,19 @@ void menu_load_and_run (void) {
     menu_check_load_address(menu, size);
     cache_data_hit_writeback_invalidate(menu, size);
     cache_inst_hit_invalidate(menu, size);
-    FF_CHECK(f_read(&fil, menu, size, &br), "Couldn't read menu file");
-    FF_CHECK((br != size) ? FR_INT_ERR : FR_OK, "Read size is different than expected");
+    direct_size = ((((uint32_t) (menu)) % 8) == 0) ? (size & ~(ROM_SECTOR_SIZE - 1)) : 0;
+    if ((direct_size > 0) && (fil.cltbl != NULL)) {
+        FF_CHECK(menu_read_runs(&fs, clmt, ROM_CODE_OFFSET, (void *) (ROM_SCRATCH_ADDRESS), direct_size) ? FR_DISK_ERR : FR_OK, "Couldn't read menu file");
+        FF_CHECK(f_lseek(&fil, ROM_CODE_OFFSET + direct_size), "Couldn't seek to menu file tail");
+        pi_dma_read((io32_t *) (ROM_SCRATCH_ADDRESS), menu, direct_size);
+    } else if (direct_size > 0) {
+        FF_CHECK(f_read(&fil, (void *) (ROM_SCRATCH_ADDRESS), direct_size, &br), "Couldn't read menu file");
+        FF_CHECK((br != direct_size) ? FR_INT_ERR : FR_OK, "Read size is different than expected");
+        pi_dma_read((io32_t *) (ROM_SCRATCH_ADDRESS), menu, direct_size);
+    }
+    FF_CHECK(f_read(&fil, (void *) (menu) + direct_size, size - direct_size, &br), "Couldn't read menu file");
+    FF_CHECK((br != (size - direct_size)) ? FR_INT_ERR : FR_OK, "Read size is different than expected");
+    cache_data_hit_writeback((void *) (menu) + direct_size, size - direct_size);
     FF_CHECK(f_close(&fil), "Couldn't close menu file");
     FF_CHECK(f_unmount(""), "Couldn't unmount drive");
 
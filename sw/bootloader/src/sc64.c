@@ -63,12 +63,16 @@ static bool sc64_wait_cpu_busy (void) {
     return (sr & SC64_SR_CMD_ERROR);
 }
 
-static bool sc64_execute_cmd (uint8_t cmd, uint32_t *args, uint32_t *result) {
+static void sc64_start_cmd (uint8_t cmd, uint32_t *args) {
     if (args != NULL) {
         pi_io_write(&SC64_REGS->DATA[0], args[0]);
         pi_io_write(&SC64_REGS->DATA[1], args[1]);
     }
     pi_io_write(&SC64_REGS->SR_CMD, ((uint32_t) (cmd)) & 0xFF);
+}
+
+static bool sc64_execute_cmd (uint8_t cmd, uint32_t *args, uint32_t *result) {
+    sc64_start_cmd(cmd, args);
     bool error = sc64_wait_cpu_busy();
     if (result != NULL) {
         result[0] = pi_io_read(&SC64_REGS->DATA[0]);
@@ -244,6 +248,24 @@ bool sc64_sd_read_sectors (void *address, uint32_t sector, uint32_t count) {
     return sc64_execute_cmd(SC64_CMD_SD_READ, read_args, NULL);
 }
 
+bool sc64_sd_read_sectors_start (void *address, uint32_t sector, uint32_t count) {
+    uint32_t sector_set_args[2] = { sector, 0 };
+    if (sc64_execute_cmd(SC64_CMD_SD_SECTOR_SET, sector_set_args, NULL)) {
+        return true;
+    }
+    sc64_sd_read_sectors_next(address, count);
+    return false;
+}
+
+void sc64_sd_read_sectors_next (void *address, uint32_t count) {
+    uint32_t read_args[2] = { (uint32_t) (address), count };
+    sc64_start_cmd(SC64_CMD_SD_READ, read_args);
+}
+
+bool sc64_sd_read_wait (void) {
+    return sc64_wait_cpu_busy();
+}
+
 bool sc64_sd_write_sectors (void *address, uint32_t sector, uint32_t count) {
     uint32_t sector_set_args[2] = { sector, 0 };
     uint32_t write_args[2] = { (uint32_t) (address), count };
@@ -36,6 +36,7 @@ typedef enum {
 
 typedef enum {
     SETTING_ID_LED_ENABLE,
+    SETTING_ID_MENU_CACHE,
 } sc64_setting_id_t;
 
 typedef enum {
@@ -144,6 +145,9 @@ sc64_sd_card_status_t sc64_sd_card_get_status (void);
 bool sc64_sd_card_get_info (void *address);
 bool sc64_sd_write_sectors (void *address, uint32_t sector, uint32_t count);
 bool sc64_sd_read_sectors (void *address, uint32_t sector, uint32_t count);
+bool sc64_sd_read_sectors_start (void *address, uint32_t sector, uint32_t count);
+void sc64_sd_read_sectors_next (void *address, uint32_t count);
+bool sc64_sd_read_wait (void);
 bool sc64_dd_set_sd_disk_info (void *address, uint32_t length);
 bool sc64_writeback_enable (void *address);
 
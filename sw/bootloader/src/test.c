@@ -1,10 +1,19 @@
 #include <stddef.h>
 #include "display.h"
+#include "fatfs/ff.h"
+#include "fatfs/diskio.h"
 #include "io.h"
 #include "sc64.h"
 #include "test.h"
 
 
+#define SPEED_TEST_BUFFER_SECTORS   (64)
+#define SPEED_TEST_TOTAL_SECTORS    (2048)
+
+
+static uint8_t speed_test_buffer[(SPEED_TEST_BUFFER_SECTORS * 512) + 8] __attribute__((aligned(8)));
+
+
 static void test_rtc (void) {
     sc64_rtc_time_t t;
     const char *weekdays[8] = {
@@ -98,6 +107,28 @@ static void test_sd_card (void) {
     display_printf(" Boot signature: 0x%02X%02X\n", sector[510], sector[511]);
 }
 
+static void test_sd_card_speed (bool aligned) {
+    BYTE *buffer = (aligned ? speed_test_buffer : (speed_test_buffer + 1));
+
+    uint32_t start = cpu_count_read();
+
+    for (int sector = 0; sector < SPEED_TEST_TOTAL_SECTORS; sector += SPEED_TEST_BUFFER_SECTORS) {
+        if (disk_read(0, buffer, sector, SPEED_TEST_BUFFER_SECTORS) != RES_OK) {
+            display_printf("SD card read speed test error!\n");
+            return;
+        }
+    }
+
+    uint32_t ms = ((cpu_count_read() - start) / (CPU_COUNT_FREQUENCY / 1000));
+    uint32_t kib = ((SPEED_TEST_TOTAL_SECTORS * 512) / 1024);
+
+    if (ms == 0) {
+        ms = 1;
+    }
+
+    display_printf("Read %d KiB (%s) in %d ms: %d KiB/s\n", (int) (kib), aligned ? "aligned" : "unaligned", (int) (ms), (int) ((kib * 1000) / ms));
+}
+
 
 bool test_check (void) {
     if (OS_INFO->reset_type != OS_INFO_RESET_TYPE_COLD) {
@@ -118,5 +149,10 @@ void test_execute (void) {
     test_sd_card();
     display_printf("\n");
 
+    display_printf("[ SD card read speed tests ]\n");
+    test_sd_card_speed(true);
+    test_sd_card_speed(false);
+    display_printf("\n");
+
     while (1);
 }
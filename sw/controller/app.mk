@@ -12,13 +12,13 @@ SRC_FILES = \
 	dd.c \
 	debug.c \
 	flash.c \
-	flashram.c \
 	fpga.c \
 	gvr.c \
 	hw.c \
 	isv.c \
 	lcmxo2.c \
 	led.c \
+	profile.c \
 	rtc.c \
 	sd.c \
 	task.c \
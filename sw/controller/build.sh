@@ -8,9 +8,13 @@ case "$1" in
         make all -j -f loader.mk USER_FLAGS="$USER_FLAGS"
         make all -j -f app.mk USER_FLAGS="$USER_FLAGS"
         ;;
+    host)
+        make all -j -f host.mk
+        ;;
     clean)
         make clean -f primer.mk
         make clean -f loader.mk
         make clean -f app.mk
+        make clean -f host.mk
         ;;
 esac
@@ -0,0 +1,62 @@
+EXE_NAME = sc64-sim
+BUILD_DIR = build/host
+
+CC = gcc
+
+CFLAGS = -O2 -g -Wall -D_GNU_SOURCE -pthread -MMD -MP -I./src -I./sim
+LDFLAGS = -pthread
+
+SRC_FILES = \
+	app.c \
+	button.c \
+	cfg.c \
+	cic.c \
+	dd.c \
+	debug.c \
+	flash.c \
+	fpga.c \
+	gvr.c \
+	isv.c \
+	led.c \
+	profile.c \
+	rtc.c \
+	sd.c \
+	timer.c \
+	update.c \
+	usb.c \
+	version.c \
+	writeback.c
+
+SIM_FILES = \
+	cpu.c \
+	hw.c \
+	i2c.c \
+	main.c \
+	model.c \
+	sdcard.c \
+	task.c \
+	usblink.c \
+	vendor.c
+
+OBJS = $(addprefix $(BUILD_DIR)/src/, $(SRC_FILES:.c=.o)) $(addprefix $(BUILD_DIR)/sim/, $(SIM_FILES:.c=.o))
+DEPS = $(OBJS:.o=.d)
+
+$(@info $(shell mkdir -p ./$(BUILD_DIR)/src ./$(BUILD_DIR)/sim &> /dev/null))
+
+$(BUILD_DIR)/src/%.o: src/%.c
+	$(CC) $(CFLAGS) -c $< -o $@
+
+$(BUILD_DIR)/sim/%.o: sim/%.c
+	$(CC) $(CFLAGS) -c $< -o $@
+
+$(BUILD_DIR)/$(EXE_NAME): $(OBJS)
+	$(CC) $(LDFLAGS) $(OBJS) -o $@
+
+all: $(BUILD_DIR)/$(EXE_NAME)
+
+clean:
+	@rm -rf ./$(BUILD_DIR)/*
+
+.PHONY: all clean
+
+-include $(DEPS)
@@ -0,0 +1,186 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "sim.h"
+
+
+#define IRQ_TIMERS          (8)
+#define IRQ_QUEUE_SIZE      (16)
+#define IRQ_TICK_PERIOD_NS  (1000000ULL)
+
+
+typedef struct {
+    bool active;
+    uint64_t deadline;
+    void (*callback)(void);
+} irq_timer_t;
+
+
+static pthread_mutex_t cpu_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cpu_turn = PTHREAD_COND_INITIALIZER;
+static uint64_t cpu_ticket_next = 0;
+static uint64_t cpu_ticket_serving = 0;
+
+static pthread_cond_t irq_cond = PTHREAD_COND_INITIALIZER;
+static irq_timer_t irq_timers[IRQ_TIMERS];
+static void (*irq_queue[IRQ_QUEUE_SIZE])(void);
+static int irq_queue_count = 0;
+static void (*irq_tick)(void) = NULL;
+static uint64_t irq_tick_next = 0;
+
+
+static void cpu_acquire (void) {
+    uint64_t ticket = cpu_ticket_next++;
+    while (ticket != cpu_ticket_serving) {
+        pthread_cond_wait(&cpu_turn, &cpu_mutex);
+    }
+}
+
+static void cpu_release (void) {
+    cpu_ticket_serving += 1;
+    pthread_cond_broadcast(&cpu_turn);
+}
+
+static void irq_dispatch (void) {
+    uint64_t now = sim_time_ns();
+
+    while (irq_tick && (now >= irq_tick_next)) {
+        irq_tick_next += IRQ_TICK_PERIOD_NS;
+        irq_tick();
+    }
+
+    for (int id = 0; id < IRQ_TIMERS; id++) {
+        irq_timer_t *timer = &irq_timers[id];
+        if (timer->active && (now >= timer->deadline)) {
+            timer->active = false;
+            timer->callback();
+        }
+    }
+
+    while (irq_queue_count > 0) {
+        void (*callback)(void) = irq_queue[0];
+        irq_queue_count -= 1;
+        for (int i = 0; i < irq_queue_count; i++) {
+            irq_queue[i] = irq_queue[i + 1];
+        }
+        callback();
+    }
+}
+
+static uint64_t irq_next_deadline (void) {
+    uint64_t next = sim_time_ns() + (100 * IRQ_TICK_PERIOD_NS);
+
+    if (irq_tick && (irq_tick_next < next)) {
+        next = irq_tick_next;
+    }
+
+    for (int id = 0; id < IRQ_TIMERS; id++) {
+        if (irq_timers[id].active && (irq_timers[id].deadline < next)) {
+            next = irq_timers[id].deadline;
+        }
+    }
+
+    return next;
+}
+
+static void *irq_thread (void *arg) {
+    sim_lock();
+
+    while (1) {
+        irq_dispatch();
+        if (irq_queue_count > 0) {
+            continue;
+        }
+        uint64_t now = sim_time_ns();
+        uint64_t next = irq_next_deadline();
+        uint32_t delay_ms = (next > now) ? (uint32_t) ((next - now + (IRQ_TICK_PERIOD_NS - 1)) / IRQ_TICK_PERIOD_NS) : 0;
+        struct timespec deadline;
+        sim_deadline(&deadline, delay_ms);
+        sim_wait(&irq_cond, &deadline);
+    }
+
+    return NULL;
+}
+
+
+void sim_lock (void) {
+    pthread_mutex_lock(&cpu_mutex);
+    cpu_acquire();
+    pthread_mutex_unlock(&cpu_mutex);
+}
+
+void sim_unlock (void) {
+    pthread_mutex_lock(&cpu_mutex);
+    cpu_release();
+    pthread_mutex_unlock(&cpu_mutex);
+}
+
+bool sim_wait (pthread_cond_t *cond, const struct timespec *deadline) {
+    int result = 0;
+
+    pthread_mutex_lock(&cpu_mutex);
+    cpu_release();
+    if (deadline != NULL) {
+        result = pthread_cond_timedwait(cond, &cpu_mutex, deadline);
+    } else {
+        result = pthread_cond_wait(cond, &cpu_mutex);
+    }
+    cpu_acquire();
+    pthread_mutex_unlock(&cpu_mutex);
+
+    return (result == ETIMEDOUT);
+}
+
+void sim_signal (pthread_cond_t *cond) {
+    pthread_mutex_lock(&cpu_mutex);
+    pthread_cond_broadcast(cond);
+    pthread_mutex_unlock(&cpu_mutex);
+}
+
+void sim_deadline (struct timespec *deadline, uint32_t ms) {
+    clock_gettime(CLOCK_REALTIME, deadline);
+    deadline->tv_sec += (ms / 1000);
+    deadline->tv_nsec += ((ms % 1000) * 1000000L);
+    if (deadline->tv_nsec >= 1000000000L) {
+        deadline->tv_sec += 1;
+        deadline->tv_nsec -= 1000000000L;
+    }
+}
+
+uint64_t sim_time_ns (void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (((uint64_t) (now.tv_sec) * 1000000000ULL) + (uint64_t) (now.tv_nsec));
+}
+
+void sim_irq_post (void (*callback)(void)) {
+    if (irq_queue_count >= IRQ_QUEUE_SIZE) {
+        fprintf(stderr, "sim: interrupt queue overflow\n");
+        abort();
+    }
+    irq_queue[irq_queue_count++] = callback;
+    sim_signal(&irq_cond);
+}
+
+void sim_irq_timer (int id, uint32_t delay_ms, void (*callback)(void)) {
+    if ((id < 0) || (id >= IRQ_TIMERS)) {
+        return;
+    }
+    irq_timers[id].active = (callback != NULL);
+    irq_timers[id].deadline = sim_time_ns() + (delay_ms * IRQ_TICK_PERIOD_NS);
+    irq_timers[id].callback = callback;
+    sim_signal(&irq_cond);
+}
+
+void sim_irq_set_tick (void (*callback)(void)) {
+    irq_tick = callback;
+    irq_tick_next = sim_time_ns() + IRQ_TICK_PERIOD_NS;
+    sim_signal(&irq_cond);
+}
+
+void sim_irq_start (void) {
+    pthread_t thread;
+    pthread_create(&thread, NULL, irq_thread, NULL);
+    pthread_detach(thread);
+}
@@ -0,0 +1,184 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "hw.h"
+#include "sim.h"
+
+
+#define GPIO_COUNT      (128)
+#define FLASH_SIZE      (64 * 1024)
+
+
+static void (*gpio_irq_rising[GPIO_COUNT])(void);
+static void (*gpio_irq_falling[GPIO_COUNT])(void);
+static uint8_t gpio_output[GPIO_COUNT];
+
+static uint32_t crc32_value = 0xFFFFFFFF;
+
+static uint8_t flash_memory[FLASH_SIZE];
+
+
+void sim_gpio_irq (int id, bool rising) {
+    void (*callback)(void) = rising ? gpio_irq_rising[id] : gpio_irq_falling[id];
+    if (callback) {
+        callback();
+    }
+}
+
+
+void hw_gpio_irq_setup (gpio_id_t id, gpio_irq_t irq, void (*callback)(void)) {
+    if (irq == GPIO_IRQ_RISING) {
+        gpio_irq_rising[id] = callback;
+    } else {
+        gpio_irq_falling[id] = callback;
+    }
+}
+
+uint32_t hw_gpio_get (gpio_id_t id) {
+    return gpio_output[id];
+}
+
+void hw_gpio_set (gpio_id_t id) {
+    gpio_output[id] = 1;
+}
+
+void hw_gpio_reset (gpio_id_t id) {
+    gpio_output[id] = 0;
+}
+
+void hw_uart_read (uint8_t *data, int length) {
+    memset(data, 0, length);
+}
+
+void hw_uart_write (uint8_t *data, int length) {
+    fwrite(data, 1, length, stdout);
+    fflush(stdout);
+}
+
+void hw_uart_wait_busy (void) {}
+
+void hw_spi_start (void) {
+    sim_fpga_spi_select(true);
+}
+
+void hw_spi_stop (void) {
+    sim_fpga_spi_select(false);
+    sim_fpga_update();
+    sim_task_preempt();
+}
+
+void hw_spi_trx (uint8_t *data, int length, spi_direction_t direction) {
+    for (int i = 0; i < length; i++) {
+        if (direction == SPI_TX) {
+            sim_fpga_spi_byte(data[i]);
+        } else {
+            data[i] = sim_fpga_spi_byte(0x00);
+        }
+    }
+}
+
+void hw_spi_trx_async (uint8_t *data, int length, spi_direction_t direction, void (*callback)(void)) {
+    hw_spi_trx(data, length, direction);
+    callback();
+}
+
+void hw_i2c_read (uint8_t i2c_address, uint8_t address, uint8_t *data, uint8_t length, void (*callback)(void)) {
+    sim_i2c_transfer(i2c_address, address, data, length, false);
+    sim_irq_post(callback);
+}
+
+void hw_i2c_write (uint8_t i2c_address, uint8_t address, uint8_t *data, uint8_t length, void (*callback)(void)) {
+    sim_i2c_transfer(i2c_address, address, data, length, true);
+    sim_irq_post(callback);
+}
+
+uint32_t hw_i2c_get_error (void) {
+    return 0;
+}
+
+void hw_i2c_raw (uint8_t i2c_address, uint8_t *tx_data, uint8_t tx_length, uint8_t *rx_data, uint8_t rx_length) {
+    memset(rx_data, 0xFF, rx_length);
+}
+
+void hw_i2c_disable_irq (void) {}
+
+void hw_i2c_enable_irq (void) {}
+
+void hw_tim_setup (tim_id_t id, uint16_t delay, void (*callback)(void)) {
+    sim_irq_timer(id, delay, callback);
+}
+
+void hw_tim_stop (tim_id_t id) {
+    sim_irq_timer(id, 0, NULL);
+}
+
+void hw_tim_disable_irq (tim_id_t id) {}
+
+void hw_tim_enable_irq (tim_id_t id) {}
+
+void hw_delay_ms (uint32_t ms) {
+    sim_unlock();
+    usleep(ms * 1000);
+    sim_lock();
+}
+
+void hw_crc32_reset (void) {
+    crc32_value = 0xFFFFFFFF;
+}
+
+uint32_t hw_crc32_calculate (uint8_t *data, uint32_t length) {
+    for (uint32_t i = 0; i < length; i++) {
+        crc32_value ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc32_value = (crc32_value >> 1) ^ ((crc32_value & 1) ? 0xEDB88320UL : 0);
+        }
+    }
+    return (crc32_value ^ 0xFFFFFFFF);
+}
+
+uint32_t hw_flash_size (void) {
+    return FLASH_SIZE;
+}
+
+void hw_flash_erase (void) {
+    memset(flash_memory, 0xFF, FLASH_SIZE);
+}
+
+void hw_flash_program (uint32_t offset, hw_flash_t value) {
+    memcpy(&flash_memory[offset], &value, sizeof(value));
+}
+
+hw_flash_t hw_flash_read (uint32_t offset) {
+    hw_flash_t value;
+    memcpy(&value, &flash_memory[offset], sizeof(value));
+    return value;
+}
+
+void hw_reset (loader_parameters_t *parameters) {
+    if (parameters != NULL) {
+        printf("sim: reset requested, loader flags 0x%08X\n", parameters->flags);
+    } else {
+        printf("sim: reset requested\n");
+    }
+    exit(0);
+}
+
+void hw_loader_get_parameters (loader_parameters_t *parameters) {
+    memset(parameters, 0, sizeof(loader_parameters_t));
+}
+
+void hw_set_vector_table (uint32_t offset) {}
+
+void hw_init (void) {
+    hw_flash_erase();
+    sim_irq_start();
+}
+
+void hw_loader_init (void) {
+    hw_init();
+}
+
+void hw_primer_init (void) {
+    hw_init();
+}
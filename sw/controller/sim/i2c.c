@@ -0,0 +1,88 @@
+#include <string.h>
+#include <time.h>
+#include "sim.h"
+
+
+#define RTC_I2C_ADDRESS     (0xDE)
+#define RTC_REGISTERS       (0x60)
+#define RTC_TIME_REGISTERS  (7)
+
+#define RTCSEC_ST           (1 << 7)
+#define RTCWKDAY_OSCRUN     (1 << 5)
+
+
+static uint8_t rtc_regs[RTC_REGISTERS];
+static time_t rtc_offset = 0;
+static bool rtc_offset_valid = false;
+
+
+static uint8_t bcd_encode (int value) {
+    return (uint8_t) (((value / 10) << 4) | (value % 10));
+}
+
+static int bcd_decode (uint8_t value) {
+    return ((((value >> 4) & 0x0F) * 10) + (value & 0x0F));
+}
+
+static void rtc_latch_time (void) {
+    if (!rtc_offset_valid) {
+        return;
+    }
+
+    time_t now = time(NULL) + rtc_offset;
+    struct tm tm;
+    gmtime_r(&now, &tm);
+
+    rtc_regs[0] = ((rtc_regs[0] & RTCSEC_ST) | bcd_encode(tm.tm_sec));
+    rtc_regs[1] = bcd_encode(tm.tm_min);
+    rtc_regs[2] = bcd_encode(tm.tm_hour);
+    rtc_regs[3] = ((rtc_regs[3] & 0xF8) | ((tm.tm_wday == 0) ? 7 : tm.tm_wday));
+    rtc_regs[4] = bcd_encode(tm.tm_mday);
+    rtc_regs[5] = ((rtc_regs[5] & 0x20) | bcd_encode(tm.tm_mon + 1));
+    rtc_regs[6] = bcd_encode(tm.tm_year % 100);
+}
+
+static void rtc_store_time (void) {
+    struct tm tm = {
+        .tm_sec = bcd_decode(rtc_regs[0] & 0x7F),
+        .tm_min = bcd_decode(rtc_regs[1] & 0x7F),
+        .tm_hour = bcd_decode(rtc_regs[2] & 0x3F),
+        .tm_mday = bcd_decode(rtc_regs[4] & 0x3F),
+        .tm_mon = (bcd_decode(rtc_regs[5] & 0x1F) - 1),
+        .tm_year = (bcd_decode(rtc_regs[6]) + 100),
+    };
+
+    rtc_offset = (timegm(&tm) - time(NULL));
+    rtc_offset_valid = (rtc_regs[0] & RTCSEC_ST);
+
+    if (rtc_offset_valid) {
+        rtc_regs[3] |= RTCWKDAY_OSCRUN;
+    } else {
+        rtc_regs[3] &= ~(RTCWKDAY_OSCRUN);
+    }
+}
+
+
+void sim_i2c_transfer (uint8_t i2c_address, uint8_t address, uint8_t *data, uint8_t length, bool write) {
+    if ((i2c_address != RTC_I2C_ADDRESS) || ((address + length) > RTC_REGISTERS)) {
+        if (!write) {
+            memset(data, 0xFF, length);
+        }
+        return;
+    }
+
+    if (write) {
+        if (address < RTC_TIME_REGISTERS) {
+            rtc_latch_time();
+        }
+        memcpy(&rtc_regs[address], data, length);
+        if (address < RTC_TIME_REGISTERS) {
+            rtc_store_time();
+        }
+    } else {
+        if (address < RTC_TIME_REGISTERS) {
+            rtc_latch_time();
+        }
+        memcpy(data, &rtc_regs[address], length);
+    }
+}
@@ -0,0 +1,59 @@
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "sim.h"
+
+
+static void sim_exit (int signal) {
+    exit(0);
+}
+
+static void usage (const char *name) {
+    fprintf(stderr, "Usage: %s [-s sd_image] [-p usb_port]\n", name);
+    exit(1);
+}
+
+
+int main (int argc, char *argv[]) {
+    uint16_t port = SIM_USB_DEFAULT_PORT;
+    int option;
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    while ((option = getopt(argc, argv, "s:p:h")) != -1) {
+        switch (option) {
+            case 's':
+                if (sim_sd_open(optarg)) {
+                    fprintf(stderr, "sim: could not open SD card image [%s]\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'p':
+                port = (uint16_t) (atoi(optarg));
+                break;
+            default:
+                usage(argv[0]);
+                break;
+        }
+    }
+
+    sim_lock();
+
+    sim_fpga_init();
+
+    atexit(sim_fpga_print_stats);
+    signal(SIGINT, sim_exit);
+    signal(SIGTERM, sim_exit);
+
+    if (sim_usb_start(port)) {
+        fprintf(stderr, "sim: could not listen on USB port %d\n", port);
+        return 1;
+    }
+
+    printf("sim: USB link listening on socket://localhost:%d\n", port);
+
+    app();
+
+    return 0;
+}
@@ -0,0 +1,756 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fpga.h"
+#include "hw.h"
+#include "sim.h"
+
+
+#define MEMORY_FLASH_ADDRESS    (0x04000000UL)
+#define MEMORY_FLASH_SIZE       (16 * 1024 * 1024)
+#define MEMORY_BUFFER_ADDRESS   (0x05000000UL)
+#define MEMORY_BUFFER_SIZE      (16 * 1024)
+#define MEMORY_SIZE             (MEMORY_BUFFER_ADDRESS + MEMORY_BUFFER_SIZE)
+
+#define FLASH_ERASE_BLOCK_SIZE  (64 * 1024)
+
+#define SPI_BUFFER_SIZE         (1024)
+#define USB_FIFO_SIZE           (1024)
+
+#define CFG_IDENTIFIER          (0x53437632UL)
+
+
+typedef enum {
+    PHASE_CMD,
+    PHASE_ADDRESS,
+    PHASE_DATA,
+    PHASE_NOP,
+} phase_t;
+
+typedef struct {
+    uint32_t address;
+    uint32_t length;
+    bool direction;
+    bool busy;
+} dma_t;
+
+
+static uint8_t *memory = NULL;
+
+static uint64_t spi_transactions = 0;
+static uint64_t spi_bytes = 0;
+
+static struct {
+    phase_t phase;
+    fpga_cmd_t cmd;
+    uint8_t counter;
+    uint8_t address;
+    uint32_t reg_rdata;
+    uint32_t reg_wdata;
+    uint8_t buffer[SPI_BUFFER_SIZE];
+    uint32_t buffer_offset;
+    bool burst_header;
+    uint8_t burst_count;
+    uint8_t burst_remaining;
+} spi;
+
+static struct {
+    uint8_t rx_fifo[USB_FIFO_SIZE];
+    uint32_t rx_head;
+    uint32_t rx_count;
+    uint8_t rx_rdata;
+    uint8_t tx_fifo[USB_FIFO_SIZE];
+    uint32_t tx_count;
+    bool reset_pending;
+    bool pwrsav;
+    dma_t dma;
+} usb;
+
+static struct {
+    uint32_t mem_address;
+    uint32_t cfg_scr;
+    uint32_t cfg_data[2];
+    uint32_t cfg_cmd;
+    bool cfg_pending;
+    bool rtc_pending;
+    uint32_t rtc_time[2];
+    uint32_t dd_scr;
+    uint32_t dd_cmd_data;
+    uint32_t dd_head_track;
+    uint32_t dd_drive_id;
+    uint16_t save_count;
+    uint32_t events_enabled;
+    uint32_t events_latched;
+    uint32_t usb_status_last;
+    bool usb_dma_busy_last;
+    uint16_t save_count_last;
+    bool sd_inserted_last;
+    bool mcu_int;
+    uint32_t copy_source;
+    uint32_t copy_destination;
+    uint32_t copy_length;
+    uint32_t copy_scr;
+    uint32_t copy_crc32;
+    uint32_t dd_block_address;
+    uint32_t dd_block_scr;
+} regs;
+
+static struct {
+    uint32_t scr;
+    uint32_t arg;
+    uint32_t cmd;
+    uint32_t rsp[4];
+    bool cmd_error;
+    bool dat_started;
+    bool dat_read;
+    bool dat_error;
+    bool dat_command;
+    uint32_t dat_blocks;
+    dma_t dma;
+} sd;
+
+
+static uint32_t usb_status (void) {
+    return ((usb.pwrsav ? (1 << 2) : 0) | (usb.reset_pending ? (1 << 0) : 0));
+}
+
+static void usb_rx_pop (void) {
+    if (usb.rx_count > 0) {
+        usb.rx_rdata = usb.rx_fifo[usb.rx_head];
+        usb.rx_head = ((usb.rx_head + 1) % USB_FIFO_SIZE);
+        usb.rx_count -= 1;
+    }
+}
+
+static void usb_tx_push (uint8_t data) {
+    if (usb.tx_count == USB_FIFO_SIZE) {
+        sim_usb_tx(usb.tx_fifo, usb.tx_count);
+        usb.tx_count = 0;
+    }
+    usb.tx_fifo[usb.tx_count++] = data;
+}
+
+static void usb_tx_flush (void) {
+    if (usb.tx_count > 0) {
+        sim_usb_tx(usb.tx_fifo, usb.tx_count);
+        usb.tx_count = 0;
+    }
+}
+
+static void usb_dma_process (void) {
+    while (usb.dma.busy && (usb.dma.length > 0)) {
+        uint8_t *data = sim_fpga_memory(usb.dma.address, 1);
+        if (usb.dma.direction) {
+            if (usb.rx_count == 0) {
+                return;
+            }
+            usb_rx_pop();
+            if (data != NULL) {
+                *data = usb.rx_rdata;
+            }
+        } else {
+            usb_tx_push((data != NULL) ? *data : 0x00);
+        }
+        usb.dma.address += 1;
+        usb.dma.length -= 1;
+    }
+    usb.dma.busy = false;
+}
+
+static void memory_write (uint32_t address, uint8_t data) {
+    uint8_t *destination = sim_fpga_memory(address, 1);
+    if (destination == NULL) {
+        return;
+    }
+    if ((address >= MEMORY_FLASH_ADDRESS) && (address < (MEMORY_FLASH_ADDRESS + MEMORY_FLASH_SIZE))) {
+        *destination &= data;
+    } else {
+        *destination = data;
+    }
+}
+
+static void mem_transfer (uint32_t scr) {
+    uint32_t length = (((scr >> 5) & 0x3FF) * 2);
+
+    if ((length == 0) || (length > SPI_BUFFER_SIZE)) {
+        length = SPI_BUFFER_SIZE;
+    }
+
+    for (uint32_t i = 0; i < length; i++) {
+        uint32_t address = (regs.mem_address & ~(1UL)) + i;
+        if (scr & MEM_SCR_DIRECTION) {
+            memory_write(address, spi.buffer[i]);
+        } else {
+            uint8_t *source = sim_fpga_memory(address, 1);
+            spi.buffer[i] = (source != NULL) ? *source : 0x00;
+        }
+    }
+}
+
+static void mem_copy (void) {
+    uint32_t source = (regs.copy_source & ~(1UL));
+    uint32_t destination = (regs.copy_destination & ~(1UL));
+    uint32_t length = ALIGN(regs.copy_length, 2);
+    uint16_t fill_data = (regs.copy_scr >> COPY_SCR_FILL_DATA_BIT);
+    uint32_t crc32 = 0xFFFFFFFF;
+
+    if (regs.copy_scr & COPY_SCR_CRC32) {
+        for (uint32_t i = 0; i < regs.copy_length; i++) {
+            uint8_t *data = sim_fpga_memory(source + i, 1);
+            crc32 ^= ((data != NULL) ? *data : 0x00);
+            for (int bit = 0; bit < 8; bit++) {
+                crc32 = (crc32 >> 1) ^ ((crc32 & 1) ? 0xEDB88320UL : 0);
+            }
+        }
+        regs.copy_crc32 = (crc32 ^ 0xFFFFFFFF);
+        return;
+    }
+
+    for (uint32_t i = 0; i < length; i++) {
+        if (regs.copy_scr & COPY_SCR_FILL) {
+            memory_write(destination + i, (i & 1) ? (fill_data & 0xFF) : (fill_data >> 8));
+        } else {
+            uint8_t *data = sim_fpga_memory(source + i, 1);
+            memory_write(destination + i, (data != NULL) ? *data : 0x00);
+        }
+    }
+}
+
+static void sd_dat_process (void) {
+    if (sd.dat_started && sd.dat_command && sd.dma.busy) {
+        uint32_t length = sd.dma.length;
+        uint32_t dat_length = ((sd.dat_blocks + 1) * 512);
+        if (length > dat_length) {
+            length = dat_length;
+        }
+        sd.dat_error = sim_sd_data(sd.dat_read, sd.dma.address, length);
+        sd.dat_started = false;
+        sd.dat_command = sim_sd_data_pending();
+        sd.dma.busy = false;
+    }
+}
+
+static void sd_cmd_execute (uint32_t cmd) {
+    uint8_t index = (cmd & SD_CMD_INDEX_MASK);
+
+    sd.cmd = cmd;
+    sd.cmd_error = false;
+
+    if (((sd.scr & SD_SCR_CLOCK_MODE_MASK) == SD_SCR_CLOCK_MODE_OFF) || !sim_sd_inserted()) {
+        sd.cmd_error = !(cmd & SD_CMD_SKIP_RESPONSE);
+        return;
+    }
+
+    memset(sd.rsp, 0, sizeof(sd.rsp));
+
+    bool error = sim_sd_cmd(index, sd.arg, sd.rsp);
+
+    if (!(cmd & SD_CMD_SKIP_RESPONSE)) {
+        sd.cmd_error = error;
+    }
+
+    sd.dat_command = sim_sd_data_pending();
+}
+
+static uint32_t events_pending (void) {
+    return (
+        regs.events_latched |
+        ((usb.rx_count > 0) ? EVENT_USB_RX : 0) |
+        (regs.rtc_pending ? EVENT_RTC : 0) |
+        (regs.cfg_pending ? EVENT_CFG_CMD : 0)
+    );
+}
+
+static uint32_t reg_read (uint8_t address) {
+    switch (address) {
+        case REG_MEM_ADDRESS:
+            return regs.mem_address;
+
+        case REG_MEM_SCR:
+            return 0;
+
+        case REG_USB_SCR:
+            return (
+                (usb.pwrsav ? USB_SCR_PWRSAV : 0) |
+                (usb.tx_count << USB_SCR_TX_COUNT_BIT) |
+                (usb.rx_count << USB_SCR_RX_COUNT_BIT) |
+                (usb.reset_pending ? USB_SCR_RESET_PENDING : 0) |
+                ((usb.tx_count < USB_FIFO_SIZE) ? USB_SCR_TXE : 0) |
+                ((usb.rx_count > 0) ? USB_SCR_RXNE : 0)
+            );
+
+        case REG_USB_DMA_ADDRESS:
+            return usb.dma.address;
+
+        case REG_USB_DMA_LENGTH:
+            return usb.dma.length;
+
+        case REG_USB_DMA_SCR:
+            return ((usb.dma.busy ? DMA_SCR_BUSY : 0) | (usb.dma.direction ? DMA_SCR_DIRECTION : 0));
+
+        case REG_CFG_SCR:
+            return regs.cfg_scr;
+
+        case REG_CFG_DATA_0:
+        case REG_CFG_DATA_1:
+            return regs.cfg_data[address - REG_CFG_DATA_0];
+
+        case REG_CFG_CMD:
+            return ((regs.cfg_pending ? CFG_CMD_PENDING : 0) | (regs.cfg_cmd & CFG_CMD_MASK));
+
+        case REG_CFG_IDENTIFIER:
+            return CFG_IDENTIFIER;
+
+        case REG_FLASH_SCR:
+            return 0;
+
+        case REG_RTC_SCR:
+            return (RTC_SCR_MAGIC | (regs.rtc_pending ? RTC_SCR_PENDING : 0));
+
+        case REG_RTC_TIME_0:
+        case REG_RTC_TIME_1:
+            return regs.rtc_time[address - REG_RTC_TIME_0];
+
+        case REG_SD_SCR:
+            return (
+                (sim_sd_inserted() ? SD_SCR_CARD_INSERTED : 0) |
+                (sd.cmd_error ? SD_SCR_CMD_ERROR : 0) |
+                (sd.scr & SD_SCR_CLOCK_MODE_MASK)
+            );
+
+        case REG_SD_ARG:
+            return sd.arg;
+
+        case REG_SD_CMD:
+            return sd.cmd;
+
+        case REG_SD_RSP_0:
+        case REG_SD_RSP_1:
+        case REG_SD_RSP_2:
+        case REG_SD_RSP_3:
+            return sd.rsp[address - REG_SD_RSP_0];
+
+        case REG_SD_DAT:
+            return ((sd.dat_error ? SD_DAT_ERROR : 0) | (sd.dat_started ? SD_DAT_BUSY : 0));
+
+        case REG_SD_DMA_ADDRESS:
+            return sd.dma.address;
+
+        case REG_SD_DMA_LENGTH:
+            return sd.dma.length;
+
+        case REG_SD_DMA_SCR:
+            return ((sd.dma.busy ? DMA_SCR_BUSY : 0) | (sd.dma.direction ? DMA_SCR_DIRECTION : 0));
+
+        case REG_DD_SCR:
+            return regs.dd_scr;
+
+        case REG_DD_CMD_DATA:
+            return regs.dd_cmd_data;
+
+        case REG_DD_HEAD_TRACK:
+            return regs.dd_head_track;
+
+        case REG_SAVE_COUNT:
+            return regs.save_count;
+
+        case REG_EVENTS:
+            return ((regs.events_enabled << EVENT_ENABLE_BIT) | events_pending());
+
+        case REG_COPY_SOURCE:
+            return regs.copy_source;
+
+        case REG_COPY_DESTINATION:
+            return regs.copy_destination;
+
+        case REG_COPY_LENGTH:
+            return regs.copy_length;
+
+        case REG_COPY_SCR:
+            return (regs.copy_scr & (COPY_SCR_FILL | COPY_SCR_CRC32 | (0xFFFFUL << COPY_SCR_FILL_DATA_BIT)));
+
+        case REG_COPY_CRC32:
+            return regs.copy_crc32;
+
+        case REG_DD_BLOCK_ADDRESS:
+            return regs.dd_block_address;
+
+        case REG_DD_BLOCK_SCR:
+            return regs.dd_block_scr;
+
+        default:
+            return 0;
+    }
+}
+
+static void reg_write (uint8_t address, uint32_t value) {
+    switch (address) {
+        case REG_MEM_ADDRESS:
+            regs.mem_address = value;
+            break;
+
+        case REG_MEM_SCR:
+            if (value & MEM_SCR_START) {
+                mem_transfer(value);
+            }
+            break;
+
+        case REG_USB_SCR:
+            if (value & USB_SCR_FIFO_FLUSH) {
+                usb.rx_count = 0;
+                usb.tx_count = 0;
+            }
+            if (value & USB_SCR_RESET_ACK) {
+                usb.reset_pending = false;
+            }
+            if (value & USB_SCR_WRITE_FLUSH) {
+                usb_tx_flush();
+            }
+            break;
+
+        case REG_USB_DMA_ADDRESS:
+            usb.dma.address = (value & 0x07FFFFFF);
+            break;
+
+        case REG_USB_DMA_LENGTH:
+            usb.dma.length = (value & 0x07FFFFFF);
+            break;
+
+        case REG_USB_DMA_SCR:
+            usb.dma.direction = (value & DMA_SCR_DIRECTION);
+            if (value & DMA_SCR_STOP) {
+                usb.dma.busy = false;
+            } else if (value & DMA_SCR_START) {
+                usb.dma.busy = true;
+                usb_dma_process();
+            }
+            break;
+
+        case REG_CFG_SCR:
+            regs.cfg_scr = ((regs.cfg_scr & CFG_SCR_BOOTLOADER_ENABLED) | (value & CFG_SCR_MCU_OWNED_MASK));
+            if (value & CFG_SCR_BOOTLOADER_WRITE) {
+                regs.cfg_scr = ((regs.cfg_scr & ~CFG_SCR_BOOTLOADER_ENABLED) | (value & CFG_SCR_BOOTLOADER_ENABLED));
+            }
+            break;
+
+        case REG_CFG_DATA_0:
+        case REG_CFG_DATA_1:
+            regs.cfg_data[address - REG_CFG_DATA_0] = value;
+            break;
+
+        case REG_CFG_CMD:
+            if (value & (CFG_CMD_DONE | CFG_CMD_ERROR)) {
+                regs.cfg_pending = false;
+            }
+            break;
+
+        case REG_FLASH_SCR: {
+            uint32_t offset = (((value >> 16) & 0xFF) * FLASH_ERASE_BLOCK_SIZE);
+            memset(&memory[MEMORY_FLASH_ADDRESS + offset], 0xFF, FLASH_ERASE_BLOCK_SIZE);
+            break;
+        }
+
+        case REG_RTC_SCR:
+            if (value & RTC_SCR_DONE) {
+                regs.rtc_pending = false;
+            }
+            break;
+
+        case REG_RTC_TIME_0:
+        case REG_RTC_TIME_1:
+            regs.rtc_time[address - REG_RTC_TIME_0] = value;
+            break;
+
+        case REG_SD_SCR:
+            sd.scr = (value & SD_SCR_CLOCK_MODE_MASK);
+            break;
+
+        case REG_SD_ARG:
+            sd.arg = value;
+            break;
+
+        case REG_SD_CMD:
+            sd_cmd_execute(value);
+            sd_dat_process();
+            break;
+
+        case REG_SD_DAT:
+            sd.dat_blocks = ((value & SD_DAT_BLOCKS_MASK) >> SD_DAT_BLOCKS_BIT);
+            if (value & SD_DAT_STOP) {
+                sd.dat_started = false;
+            }
+            if (value & (SD_DAT_START_READ | SD_DAT_START_WRITE)) {
+                sd.dat_started = true;
+                sd.dat_read = (value & SD_DAT_START_READ);
+                sd.dat_error = false;
+            }
+            break;
+
+        case REG_SD_DMA_ADDRESS:
+            sd.dma.address = (value & 0x07FFFFFF);
+            break;
+
+        case REG_SD_DMA_LENGTH:
+            sd.dma.length = (value & 0x07FFFFFF);
+            break;
+
+        case REG_SD_DMA_SCR:
+            sd.dma.direction = (value & DMA_SCR_DIRECTION);
+            if (value & DMA_SCR_STOP) {
+                sd.dma.busy = false;
+            } else if (value & DMA_SCR_START) {
+                sd.dma.busy = true;
+                sd_dat_process();
+            }
+            break;
+
+        case REG_DD_SCR:
+            regs.dd_scr = (value & (DD_SCR_DISK_INSERTED | DD_SCR_DISK_CHANGED));
+            break;
+
+        case REG_DD_CMD_DATA:
+            regs.dd_cmd_data = (value & 0xFFFF);
+            break;
+
+        case REG_DD_HEAD_TRACK:
+            regs.dd_head_track = (value & (DD_HEAD_TRACK_INDEX_LOCK | DD_HEAD_TRACK_MASK));
+            break;
+
+        case REG_DD_DRIVE_ID:
+            regs.dd_drive_id = (value & 0xFFFF);
+            break;
+
+        case REG_EVENTS:
+            regs.events_enabled = ((value >> EVENT_ENABLE_BIT) & EVENT_PENDING_MASK);
+            regs.events_latched &= ~(value & EVENT_LATCHED_MASK);
+            break;
+
+        case REG_COPY_SOURCE:
+            regs.copy_source = (value & 0x07FFFFFF);
+            break;
+
+        case REG_COPY_DESTINATION:
+            regs.copy_destination = (value & 0x07FFFFFF);
+            break;
+
+        case REG_COPY_LENGTH:
+            regs.copy_length = (value & 0x07FFFFFF);
+            break;
+
+        case REG_COPY_SCR:
+            regs.copy_scr = value;
+            if (value & COPY_SCR_START) {
+                mem_copy();
+            }
+            break;
+
+        case REG_DD_BLOCK_ADDRESS:
+            regs.dd_block_address = (value & 0x07FFFFFF);
+            break;
+
+        case REG_DD_BLOCK_SCR:
+            regs.dd_block_scr = (value & ((0xFFUL << DD_BLOCK_SCR_SECTORS_BIT) | (0xFF << DD_BLOCK_SCR_SECTOR_SIZE_BIT) | DD_BLOCK_SCR_WRITE));
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+void sim_fpga_init (void) {
+    memory = calloc(MEMORY_SIZE, 1);
+    memset(&memory[MEMORY_FLASH_ADDRESS], 0xFF, MEMORY_FLASH_SIZE);
+    regs.cfg_scr = CFG_SCR_BOOTLOADER_ENABLED;
+    usb.pwrsav = true;
+    regs.usb_status_last = usb_status();
+    regs.sd_inserted_last = sim_sd_inserted();
+}
+
+void sim_fpga_spi_select (bool selected) {
+    if (selected) {
+        spi_transactions += 1;
+        spi.phase = PHASE_CMD;
+        spi.counter = 0;
+    }
+}
+
+uint8_t sim_fpga_spi_byte (uint8_t data) {
+    uint8_t response = 0x00;
+
+    spi_bytes += 1;
+
+    switch (spi.cmd) {
+        case CMD_IDENTIFY:
+            response = FPGA_ID;
+            break;
+        case CMD_REG_READ:
+            response = ((spi.reg_rdata >> (spi.counter * 8)) & 0xFF);
+            break;
+        case CMD_MEM_READ:
+            response = spi.buffer[spi.buffer_offset];
+            break;
+        case CMD_USB_STATUS:
+            response = (((usb.tx_count < USB_FIFO_SIZE) ? USB_STATUS_TXE : 0) | ((usb.rx_count > 0) ? USB_STATUS_RXNE : 0));
+            break;
+        case CMD_USB_READ:
+            response = usb.rx_rdata;
+            break;
+        case CMD_USB_READ_BURST:
+        case CMD_USB_WRITE_BURST:
+            response = spi.burst_header ? spi.burst_count : ((spi.cmd == CMD_USB_READ_BURST) ? usb.rx_rdata : 0x00);
+            break;
+        default:
+            break;
+    }
+
+    switch (spi.phase) {
+        case PHASE_CMD:
+            spi.cmd = (fpga_cmd_t) (data);
+            spi.phase = PHASE_ADDRESS;
+            if (spi.cmd == CMD_USB_STATUS) {
+                spi.phase = PHASE_NOP;
+            }
+            if (spi.cmd == CMD_USB_READ) {
+                usb_rx_pop();
+                spi.phase = PHASE_DATA;
+            }
+            if (spi.cmd == CMD_USB_WRITE) {
+                spi.phase = PHASE_DATA;
+            }
+            if (spi.cmd == CMD_USB_WRITE_BURST) {
+                uint32_t free = (USB_FIFO_SIZE - usb.tx_count);
+                spi.burst_header = true;
+                spi.burst_count = (free > FPGA_MAX_USB_BURST) ? FPGA_MAX_USB_BURST : free;
+                spi.phase = PHASE_DATA;
+            }
+            break;
+
+        case PHASE_ADDRESS:
+            spi.address = data;
+            spi.phase = PHASE_DATA;
+            spi.buffer_offset = ((data * 4) % SPI_BUFFER_SIZE);
+            if (spi.cmd == CMD_USB_READ_BURST) {
+                spi.burst_header = true;
+                spi.burst_count = (usb.rx_count < data) ? usb.rx_count : data;
+                spi.burst_remaining = spi.burst_count;
+            }
+            if (spi.cmd == CMD_REG_READ) {
+                spi.reg_rdata = reg_read(spi.address++);
+            }
+            break;
+
+        case PHASE_DATA:
+            if (spi.cmd == CMD_REG_READ) {
+                if (spi.counter == 3) {
+                    spi.reg_rdata = reg_read(spi.address++);
+                }
+            }
+            if (spi.cmd == CMD_REG_WRITE) {
+                spi.reg_wdata = ((spi.reg_wdata >> 8) | (data << 24));
+                if (spi.counter == 3) {
+                    reg_write(spi.address++, spi.reg_wdata);
+                }
+            }
+            if (spi.cmd == CMD_MEM_READ) {
+                spi.buffer_offset = ((spi.buffer_offset + 1) % SPI_BUFFER_SIZE);
+            }
+            if (spi.cmd == CMD_MEM_WRITE) {
+                spi.buffer[spi.buffer_offset] = data;
+                spi.buffer_offset = ((spi.buffer_offset + 1) % SPI_BUFFER_SIZE);
+            }
+            if (spi.cmd == CMD_USB_READ) {
+                spi.phase = PHASE_NOP;
+            }
+            if (spi.cmd == CMD_USB_WRITE) {
+                usb_tx_push(data);
+                spi.phase = PHASE_NOP;
+            }
+            if (spi.cmd == CMD_USB_READ_BURST) {
+                spi.burst_header = false;
+                if (spi.burst_remaining > 0) {
+                    usb_rx_pop();
+                    spi.burst_remaining -= 1;
+                }
+            }
+            if (spi.cmd == CMD_USB_WRITE_BURST) {
+                if (!spi.burst_header && (usb.tx_count < USB_FIFO_SIZE)) {
+                    usb_tx_push(data);
+                }
+                spi.burst_header = false;
+            }
+            spi.counter = ((spi.counter + 1) % 4);
+            break;
+
+        case PHASE_NOP:
+            break;
+    }
+
+    return response;
+}
+
+void sim_fpga_update (void) {
+    usb_dma_process();
+    usb_tx_flush();
+
+    uint32_t usb_status_current = usb_status();
+    bool sd_inserted = sim_sd_inserted();
+
+    if (regs.usb_status_last != usb_status_current) {
+        regs.events_latched |= EVENT_USB_STATUS;
+    }
+    if (regs.usb_dma_busy_last && !usb.dma.busy) {
+        regs.events_latched |= EVENT_USB_DMA;
+    }
+    if (regs.save_count_last != regs.save_count) {
+        regs.events_latched |= EVENT_SAVE_COUNT;
+    }
+    if (regs.sd_inserted_last != sd_inserted) {
+        regs.events_latched |= EVENT_SD_DET;
+    }
+
+    regs.usb_status_last = usb_status_current;
+    regs.usb_dma_busy_last = usb.dma.busy;
+    regs.save_count_last = regs.save_count;
+    regs.sd_inserted_last = sd_inserted;
+
+    bool mcu_int = ((events_pending() & regs.events_enabled) != 0);
+
+    if (mcu_int && !regs.mcu_int) {
+        sim_gpio_irq(GPIO_ID_FPGA_INT, true);
+    }
+
+    regs.mcu_int = mcu_int;
+}
+
+void sim_fpga_print_stats (void) {
+    printf("sim: %llu SPI transactions, %llu bytes\n", (unsigned long long) (spi_transactions), (unsigned long long) (spi_bytes));
+}
+
+uint8_t *sim_fpga_memory (uint32_t address, size_t length) {
+    if ((address >= MEMORY_SIZE) || (length > (MEMORY_SIZE - address))) {
+        return NULL;
+    }
+    return &memory[address];
+}
+
+size_t sim_fpga_usb_rx_free (void) {
+    return (USB_FIFO_SIZE - usb.rx_count);
+}
+
+void sim_fpga_usb_rx_push (uint8_t *data, size_t length) {
+    for (size_t i = 0; (i < length) && (usb.rx_count < USB_FIFO_SIZE); i++) {
+        usb.rx_fifo[(usb.rx_head + usb.rx_count) % USB_FIFO_SIZE] = data[i];
+        usb.rx_count += 1;
+    }
+    sim_fpga_update();
+}
+
+void sim_fpga_usb_link (bool connected) {
+    usb.pwrsav = !connected;
+    usb.reset_pending = connected;
+    usb.rx_count = 0;
+    usb.tx_count = 0;
+    usb.dma.busy = false;
+    sim_fpga_update();
+}
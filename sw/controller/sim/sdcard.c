@@ -0,0 +1,245 @@
+#include <stdio.h>
+#include <string.h>
+#include "sim.h"
+
+
+#define SECTOR_SIZE         (512)
+#define SWITCH_STATUS_SIZE  (64)
+#define SCR_SIZE            (8)
+
+#define R1_APP_CMD          (1 << 5)
+#define R1_READY_FOR_DATA   (1 << 8)
+#define R1_STATE_TRAN       (4 << 9)
+
+#define R3_OCR              (0x300000UL)
+#define R3_CCS              (1UL << 30)
+#define R3_BUSY             (1UL << 31)
+
+#define R6_RCA              (0x12340000UL)
+
+
+typedef enum {
+    DATA_NONE,
+    DATA_SWITCH,
+    DATA_SCR,
+    DATA_READ,
+    DATA_WRITE,
+} data_t;
+
+
+static FILE *image = NULL;
+static uint32_t image_sectors = 0;
+static bool app_cmd = false;
+static bool hs_enabled = false;
+static data_t data_pending = DATA_NONE;
+static uint32_t data_sector = 0;
+static uint32_t data_blocks = 0;
+static uint32_t block_count = 0;
+static uint8_t scr[SCR_SIZE] = {
+    0x02, 0x35, 0x80, 0x02, 0x00, 0x00, 0x00, 0x00,
+};
+static uint8_t csd[16];
+static uint8_t cid[16] = {
+    0x00, 'S', 'C', 'S', 'I', 'M', '6', '4',
+    0x10, 0x00, 0x00, 0x00, 0x01, 0x01, 0x60, 0x01,
+};
+
+
+static uint32_t r1 (void) {
+    return (R1_STATE_TRAN | R1_READY_FOR_DATA | (app_cmd ? R1_APP_CMD : 0));
+}
+
+static void r2 (uint8_t *data, uint32_t *rsp) {
+    for (int i = 0; i < 4; i++) {
+        rsp[3 - i] = ((data[(i * 4) + 0] << 24) | (data[(i * 4) + 1] << 16) | (data[(i * 4) + 2] << 8) | data[(i * 4) + 3]);
+    }
+}
+
+static void csd_create (void) {
+    uint32_t c_size = ((image_sectors / 1024) - 1);
+
+    memset(csd, 0, sizeof(csd));
+    csd[0] = 0x40;
+    csd[1] = 0x0E;
+    csd[3] = 0x32;
+    csd[4] = 0x5B;
+    csd[5] = 0x59;
+    csd[7] = ((c_size >> 16) & 0x3F);
+    csd[8] = ((c_size >> 8) & 0xFF);
+    csd[9] = (c_size & 0xFF);
+    csd[10] = 0x7F;
+    csd[11] = 0x80;
+    csd[12] = 0x0A;
+    csd[13] = 0x40;
+    csd[15] = 0x01;
+}
+
+
+bool sim_sd_open (const char *path) {
+    image = fopen(path, "r+b");
+    if (image == NULL) {
+        return true;
+    }
+    fseek(image, 0, SEEK_END);
+    image_sectors = (uint32_t) (ftell(image) / SECTOR_SIZE);
+    if (image_sectors < 1024) {
+        fclose(image);
+        image = NULL;
+        return true;
+    }
+    csd_create();
+    return false;
+}
+
+bool sim_sd_inserted (void) {
+    return (image != NULL);
+}
+
+bool sim_sd_cmd (uint8_t index, uint32_t arg, uint32_t *rsp) {
+    bool acmd = app_cmd;
+
+    app_cmd = false;
+
+    if (acmd) {
+        switch (index) {
+            case 6:
+                rsp[0] = r1();
+                return false;
+            case 41:
+                rsp[0] = (R3_BUSY | R3_CCS | R3_OCR);
+                return false;
+            case 51:
+                data_pending = DATA_SCR;
+                rsp[0] = r1();
+                return false;
+            default:
+                return true;
+        }
+    }
+
+    switch (index) {
+        case 0:
+            data_pending = DATA_NONE;
+            hs_enabled = false;
+            return false;
+        case 2:
+            r2(cid, rsp);
+            return false;
+        case 3:
+            rsp[0] = R6_RCA;
+            return false;
+        case 6:
+            if (arg & (1UL << 31)) {
+                hs_enabled = ((arg & 0xF) == 1);
+            }
+            data_pending = DATA_SWITCH;
+            rsp[0] = r1();
+            return false;
+        case 7:
+            rsp[0] = r1();
+            return false;
+        case 8:
+            rsp[0] = (arg & 0xFFF);
+            return false;
+        case 9:
+            r2(csd, rsp);
+            return false;
+        case 10:
+            r2(cid, rsp);
+            return false;
+        case 12:
+            data_pending = DATA_NONE;
+            rsp[0] = r1();
+            return false;
+        case 13:
+            rsp[0] = r1();
+            return false;
+        case 17:
+        case 18:
+        case 24:
+        case 25:
+            if (arg >= image_sectors) {
+                block_count = 0;
+                return true;
+            }
+            data_pending = ((index == 17) || (index == 18)) ? DATA_READ : DATA_WRITE;
+            data_sector = arg;
+            data_blocks = ((index == 17) || (index == 24)) ? 1 : block_count;
+            block_count = 0;
+            rsp[0] = r1();
+            return false;
+        case 23:
+            block_count = (arg & 0xFFFF);
+            rsp[0] = r1();
+            return false;
+        case 55:
+            app_cmd = true;
+            rsp[0] = r1();
+            return false;
+        default:
+            return true;
+    }
+}
+
+bool sim_sd_data_pending (void) {
+    return (data_pending != DATA_NONE);
+}
+
+bool sim_sd_data (bool read, uint32_t address, uint32_t length) {
+    uint8_t *buffer = sim_fpga_memory(address, length);
+    data_t data = data_pending;
+
+    data_pending = DATA_NONE;
+
+    if (buffer == NULL) {
+        return true;
+    }
+
+    if (data == DATA_SCR) {
+        memcpy(buffer, scr, (length < sizeof(scr)) ? length : sizeof(scr));
+        return !read;
+    }
+
+    if (data == DATA_SWITCH) {
+        uint8_t status[SWITCH_STATUS_SIZE];
+        memset(status, 0, sizeof(status));
+        status[1] = 0x64;
+        status[12] = 0x80;
+        status[13] = 0x03;
+        status[16] = (hs_enabled ? 0x01 : 0x00);
+        memcpy(buffer, status, (length < sizeof(status)) ? length : sizeof(status));
+        return !read;
+    }
+
+    if ((data == DATA_NONE) || (read != (data == DATA_READ))) {
+        return true;
+    }
+
+    uint32_t sectors = (length / SECTOR_SIZE);
+
+    if ((data_sector + sectors) > image_sectors) {
+        return true;
+    }
+
+    fseek(image, (long) (data_sector) * SECTOR_SIZE, SEEK_SET);
+
+    if (read) {
+        if (fread(buffer, SECTOR_SIZE, sectors, image) != sectors) {
+            return true;
+        }
+    } else {
+        if (fwrite(buffer, SECTOR_SIZE, sectors, image) != sectors) {
+            return true;
+        }
+        fflush(image);
+    }
+
+    data_sector += sectors;
+
+    if ((data_blocks == 0) || (sectors < data_blocks)) {
+        data_blocks -= ((data_blocks == 0) ? 0 : sectors);
+        data_pending = data;
+    }
+
+    return false;
+}
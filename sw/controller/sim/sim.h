@@ -0,0 +1,55 @@
+#ifndef SIM_H__
+#define SIM_H__
+
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+
+#define SIM_USB_DEFAULT_PORT    (6464)
+
+
+void app (void);
+
+void sim_lock (void);
+void sim_unlock (void);
+bool sim_wait (pthread_cond_t *cond, const struct timespec *deadline);
+void sim_signal (pthread_cond_t *cond);
+void sim_deadline (struct timespec *deadline, uint32_t ms);
+uint64_t sim_time_ns (void);
+
+void sim_irq_post (void (*callback)(void));
+void sim_irq_timer (int id, uint32_t delay_ms, void (*callback)(void));
+void sim_irq_set_tick (void (*callback)(void));
+void sim_irq_start (void);
+
+void sim_task_preempt (void);
+
+void sim_gpio_irq (int id, bool rising);
+
+void sim_fpga_init (void);
+void sim_fpga_spi_select (bool selected);
+uint8_t sim_fpga_spi_byte (uint8_t data);
+void sim_fpga_update (void);
+void sim_fpga_print_stats (void);
+uint8_t *sim_fpga_memory (uint32_t address, size_t length);
+size_t sim_fpga_usb_rx_free (void);
+void sim_fpga_usb_rx_push (uint8_t *data, size_t length);
+void sim_fpga_usb_link (bool connected);
+
+bool sim_sd_open (const char *path);
+bool sim_sd_inserted (void);
+bool sim_sd_cmd (uint8_t index, uint32_t arg, uint32_t *rsp);
+bool sim_sd_data_pending (void);
+bool sim_sd_data (bool read, uint32_t address, uint32_t length);
+
+bool sim_usb_start (uint16_t port);
+void sim_usb_tx (uint8_t *data, size_t length);
+
+void sim_i2c_transfer (uint8_t i2c_address, uint8_t address, uint8_t *data, uint8_t length, bool write);
+
+
+#endif
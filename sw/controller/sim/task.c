@@ -0,0 +1,222 @@
+#include <pthread.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include "sim.h"
+#include "task.h"
+
+
+#define TASK_CYCLES_PER_MS      (64000)
+#define TASK_STACK_FILL_VALUE   (0xDEADBEEF)
+#define TASK_IDLE_STACK_SIZE    (256)
+
+
+typedef enum {
+    TASK_FLAG_NONE  = 0,
+    TASK_FLAG_READY = (1 << 0),
+    TASK_FLAG_RESET = (1 << 1),
+    TASK_FLAG_SLEEPING = (1 << 2),
+} task_flags_t;
+
+
+typedef struct {
+    void (*code)(void);
+    task_flags_t flags;
+    task_priority_t priority;
+    uint32_t wakeup_tick;
+    uint64_t run_time;
+    pthread_t thread;
+    pthread_cond_t turn;
+    jmp_buf reset_point;
+} task_t;
+
+
+static task_t task_table[__TASK_ID_MAX];
+static volatile task_id_t task_current = TASK_ID_IDLE;
+static volatile uint32_t task_ticks = 0;
+static uint32_t task_switch_timestamp = 0;
+static uint64_t task_start_ns = 0;
+static __thread int task_self = -1;
+static uint8_t task_idle_stack[TASK_IDLE_STACK_SIZE];
+
+
+static void task_schedule (void) {
+    uint32_t now = task_get_cycles();
+    uint32_t elapsed = (now - task_switch_timestamp);
+
+    if (((int32_t) (elapsed)) > 0) {
+        task_table[task_current].run_time += elapsed;
+        task_switch_timestamp = now;
+    }
+
+    task_id_t next = TASK_ID_IDLE;
+
+    for (task_id_t id = 0; id < __TASK_ID_MAX; id++) {
+        if ((task_table[id].flags & TASK_FLAG_READY) && (task_table[id].priority > task_table[next].priority)) {
+            next = id;
+        }
+    }
+
+    if (next != task_current) {
+        task_current = next;
+        sim_signal(&task_table[next].turn);
+    }
+}
+
+static void task_wait_turn (void) {
+    if (task_self < 0) {
+        return;
+    }
+
+    task_t *task = &task_table[task_self];
+
+    while (task_current != task_self) {
+        sim_wait(&task->turn, NULL);
+    }
+
+    if (task->flags & TASK_FLAG_RESET) {
+        task->flags &= ~(TASK_FLAG_RESET);
+        longjmp(task->reset_point, 1);
+    }
+}
+
+static void task_sleep_until (uint32_t tick) {
+    task_t *task = &task_table[task_current];
+    task->wakeup_tick = tick;
+    task->flags = ((task->flags & ~(TASK_FLAG_READY)) | TASK_FLAG_SLEEPING);
+    task_schedule();
+    task_wait_turn();
+}
+
+static void task_idle (void) {
+    while (1) {
+        sim_wait(&task_table[TASK_ID_IDLE].turn, NULL);
+        task_wait_turn();
+    }
+}
+
+static void task_tick (void) {
+    task_ticks += 1;
+
+    for (task_id_t id = 0; id < __TASK_ID_MAX; id++) {
+        task_t *task = &task_table[id];
+        if ((task->flags & TASK_FLAG_SLEEPING) && (((int32_t) (task_ticks - task->wakeup_tick)) >= 0)) {
+            task->flags = ((task->flags & ~(TASK_FLAG_SLEEPING)) | TASK_FLAG_READY);
+            task_schedule();
+        }
+    }
+}
+
+static void *task_thread (void *arg) {
+    task_self = (int) ((intptr_t) (arg));
+    task_t *task = &task_table[task_self];
+
+    sim_lock();
+
+    setjmp(task->reset_point);
+
+    task_wait_turn();
+
+    task->code();
+
+    task->flags = TASK_FLAG_NONE;
+    task_yield();
+
+    return NULL;
+}
+
+
+void sim_task_preempt (void) {
+    sim_unlock();
+    sim_lock();
+    task_wait_turn();
+}
+
+void task_create (task_id_t id, void (*code)(void), void *stack, size_t stack_size, task_priority_t priority) {
+    if (id < __TASK_ID_MAX) {
+        for (size_t i = 0; i < stack_size; i += sizeof(uint32_t)) {
+            (*(uint32_t *) (stack + i)) = TASK_STACK_FILL_VALUE;
+        }
+        task_t *task = &task_table[id];
+        task->code = code;
+        task->flags = TASK_FLAG_READY;
+        task->priority = priority;
+        task->run_time = 0;
+        pthread_cond_init(&task->turn, NULL);
+    }
+}
+
+void task_yield (void) {
+    task_table[task_current].flags &= ~(TASK_FLAG_READY);
+    task_schedule();
+    task_wait_turn();
+}
+
+void task_sleep_ms (uint32_t ms) {
+    task_sleep_until(task_ticks + ms);
+}
+
+bool task_wait (volatile bool *condition, uint32_t timeout_ms) {
+    uint32_t deadline = task_ticks + timeout_ms;
+
+    while (1) {
+        if (*condition) {
+            return false;
+        }
+        if (((int32_t) (task_ticks - deadline)) >= 0) {
+            return true;
+        }
+        task_sleep_until(deadline);
+    }
+}
+
+void task_set_ready (task_id_t id) {
+    task_table[id].flags = ((task_table[id].flags & ~(TASK_FLAG_SLEEPING)) | TASK_FLAG_READY);
+    task_schedule();
+}
+
+void task_set_ready_and_reset (task_id_t id) {
+    task_table[id].flags = ((task_table[id].flags & ~(TASK_FLAG_SLEEPING)) | TASK_FLAG_RESET | TASK_FLAG_READY);
+    task_schedule();
+}
+
+size_t task_get_stack_usage (void *stack, size_t stack_size) {
+    return 0;
+}
+
+uint32_t task_get_ticks (void) {
+    return task_ticks;
+}
+
+uint32_t task_get_cycles (void) {
+    return (uint32_t) (((sim_time_ns() - task_start_ns) * TASK_CYCLES_PER_MS) / 1000000ULL);
+}
+
+uint64_t task_get_run_time (task_id_t id) {
+    uint64_t run_time = task_table[id].run_time;
+    if (id == task_current) {
+        run_time += (task_get_cycles() - task_switch_timestamp);
+    }
+    return run_time;
+}
+
+void task_scheduler_start (void) {
+    task_create(TASK_ID_IDLE, task_idle, task_idle_stack, TASK_IDLE_STACK_SIZE, TASK_PRIORITY_IDLE);
+
+    task_start_ns = sim_time_ns();
+    task_switch_timestamp = task_get_cycles();
+
+    for (task_id_t id = 0; id < __TASK_ID_MAX; id++) {
+        if (task_table[id].code != NULL) {
+            pthread_create(&task_table[id].thread, NULL, task_thread, (void *) ((intptr_t) (id)));
+        }
+    }
+
+    sim_irq_set_tick(task_tick);
+
+    task_schedule();
+    sim_signal(&task_table[task_current].turn);
+
+    sim_unlock();
+
+    pthread_join(task_table[TASK_ID_IDLE].thread, NULL);
+}
@@ -0,0 +1,110 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "sim.h"
+
+
+#define USB_RX_CHUNK_SIZE   (4096)
+
+
+static int usb_server = -1;
+static volatile int usb_client = -1;
+
+
+static void usb_receive (int client) {
+    uint8_t buffer[USB_RX_CHUNK_SIZE];
+
+    while (1) {
+        ssize_t length = recv(client, buffer, sizeof(buffer), 0);
+        if (length <= 0) {
+            return;
+        }
+        size_t offset = 0;
+        while (offset < (size_t) (length)) {
+            sim_lock();
+            size_t free = sim_fpga_usb_rx_free();
+            size_t chunk = ((length - offset) < free) ? (length - offset) : free;
+            if (chunk > 0) {
+                sim_fpga_usb_rx_push(&buffer[offset], chunk);
+                offset += chunk;
+            }
+            sim_unlock();
+            if (chunk == 0) {
+                usleep(100);
+            }
+        }
+    }
+}
+
+static void *usb_thread (void *arg) {
+    while (1) {
+        int client = accept(usb_server, NULL, NULL);
+        if (client < 0) {
+            continue;
+        }
+
+        int option = 1;
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &option, sizeof(option));
+
+        sim_lock();
+        usb_client = client;
+        sim_fpga_usb_link(true);
+        sim_unlock();
+
+        usb_receive(client);
+
+        sim_lock();
+        usb_client = -1;
+        sim_fpga_usb_link(false);
+        sim_unlock();
+
+        close(client);
+    }
+
+    return NULL;
+}
+
+
+bool sim_usb_start (uint16_t port) {
+    struct sockaddr_in address = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    int option = 1;
+
+    usb_server = socket(AF_INET, SOCK_STREAM, 0);
+    if (usb_server < 0) {
+        return true;
+    }
+    setsockopt(usb_server, SOL_SOCKET, SO_REUSEADDR, &option, sizeof(option));
+    if (bind(usb_server, (struct sockaddr *) (&address), sizeof(address)) < 0) {
+        return true;
+    }
+    if (listen(usb_server, 1) < 0) {
+        return true;
+    }
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, usb_thread, NULL);
+    pthread_detach(thread);
+
+    return false;
+}
+
+void sim_usb_tx (uint8_t *data, size_t length) {
+    int client = usb_client;
+
+    while ((client >= 0) && (length > 0)) {
+        ssize_t sent = send(client, data, length, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            return;
+        }
+        data += sent;
+        length -= sent;
+    }
+}
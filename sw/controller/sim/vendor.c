@@ -0,0 +1,21 @@
+#include "vendor.h"
+
+
+uint32_t vendor_flash_size (void) {
+    return 0;
+}
+
+vendor_error_t vendor_backup (uint32_t address, uint32_t *length) {
+    *length = 0;
+    return VENDOR_ERROR_INIT;
+}
+
+vendor_error_t vendor_update (uint32_t address, uint32_t length) {
+    return VENDOR_ERROR_INIT;
+}
+
+vendor_error_t vendor_reconfigure (void) {
+    return VENDOR_ERROR_INIT;
+}
+
+void vendor_initial_configuration (vendor_get_cmd_t get_cmd, vendor_send_response_t send_response) {}
@@ -30,10 +30,10 @@ void app (void) {
     hw_init();
     cic_hw_init();
 
-    task_create(TASK_ID_CIC, cic_task, cic_stack, CIC_STACK_SIZE);
-    task_create(TASK_ID_RTC, rtc_task, rtc_stack, RTC_STACK_SIZE);
-    task_create(TASK_ID_LED, led_task, led_stack, LED_STACK_SIZE);
-    task_create(TASK_ID_GVR, gvr_task, gvr_stack, GVR_STACK_SIZE);
+    task_create(TASK_ID_CIC, cic_task, cic_stack, CIC_STACK_SIZE, TASK_PRIORITY_HIGH);
+    task_create(TASK_ID_RTC, rtc_task, rtc_stack, RTC_STACK_SIZE, TASK_PRIORITY_NORMAL);
+    task_create(TASK_ID_LED, led_task, led_stack, LED_STACK_SIZE, TASK_PRIORITY_NORMAL);
+    task_create(TASK_ID_GVR, gvr_task, gvr_stack, GVR_STACK_SIZE, TASK_PRIORITY_LOW);
 
     task_scheduler_start();
 }
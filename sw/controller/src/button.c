@@ -39,6 +39,10 @@ button_mode_t button_get_mode (void) {
     return p.mode;
 }
 
+bool button_is_busy (void) {
+    return (p.trigger || (p.counter != (p.state ? BUTTON_COUNTER_TRIGGER_ON : BUTTON_COUNTER_TRIGGER_OFF)));
+}
+
 void button_init (void) {
     p.counter = 0;
     p.state = false;
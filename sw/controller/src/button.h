@@ -16,6 +16,7 @@ typedef enum {
 bool button_get_state (void);
 bool button_set_mode (button_mode_t mode);
 button_mode_t button_get_mode (void);
+bool button_is_busy (void);
 void button_init (void);
 void button_process (void);
 
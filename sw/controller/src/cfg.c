@@ -36,6 +36,7 @@ typedef enum {
 
 typedef enum {
     SETTING_ID_LED_ENABLE,
+    SETTING_ID_MENU_CACHE,
 } setting_id_t;
 
 typedef enum {
@@ -95,6 +96,8 @@ struct process {
     tv_type_t tv_type;
     bool usb_output_ready;
     uint32_t sd_card_sector;
+    bool sd_card_request_pending;
+    uint32_t sd_card_request_args[2];
 };
 
 
@@ -167,11 +170,34 @@ static void cfg_set_error (cfg_error_t error) {
     fpga_reg_set(REG_CFG_CMD, CFG_CMD_ERROR | CFG_CMD_DONE);
 }
 
+static void cfg_sd_card_request_done (bool error) {
+    p.sd_card_request_pending = false;
+    if (error) {
+        cfg_set_error(CFG_ERROR_SD_CARD);
+        return;
+    }
+    p.sd_card_sector += p.sd_card_request_args[1];
+    fpga_reg_set(REG_CFG_DATA_0, p.sd_card_request_args[0]);
+    fpga_reg_set(REG_CFG_DATA_1, p.sd_card_request_args[1]);
+    fpga_reg_set(REG_CFG_CMD, CFG_CMD_DONE);
+}
+
+static void cfg_sd_card_request (uint32_t *args, bool write) {
+    p.sd_card_request_pending = true;
+    p.sd_card_request_args[0] = args[0];
+    p.sd_card_request_args[1] = args[1];
+    sd_enqueue(args[0], p.sd_card_sector, args[1], write, cfg_sd_card_request_done);
+}
+
 static void cfg_change_scr_bits (uint32_t mask, bool value) {
+    uint32_t scr = fpga_reg_get_shadow(REG_CFG_SCR);
+    if (mask & CFG_SCR_BOOTLOADER_ENABLED) {
+        scr |= CFG_SCR_BOOTLOADER_WRITE;
+    }
     if (value) {
-        fpga_reg_set(REG_CFG_SCR, fpga_reg_get(REG_CFG_SCR) | mask);
+        fpga_reg_set(REG_CFG_SCR, scr | mask);
     } else {
-        fpga_reg_set(REG_CFG_SCR, fpga_reg_get(REG_CFG_SCR) & (~mask));
+        fpga_reg_set(REG_CFG_SCR, scr & (~mask));
     }
 }
 
@@ -375,6 +401,10 @@ bool cfg_query_setting (uint32_t *args) {
             args[1] = settings.led_enabled;
             break;
         default:
+            if ((args[0] >= SETTING_ID_MENU_CACHE) && (args[0] < (SETTING_ID_MENU_CACHE + RTC_SETTINGS_MENU_CACHE_WORDS))) {
+                args[1] = settings.menu_cache[args[0] - SETTING_ID_MENU_CACHE];
+                break;
+            }
             return true;
     }
 
@@ -389,6 +419,10 @@ bool cfg_update_setting (uint32_t *args) {
             settings.led_enabled = args[1];
             break;
         default:
+            if ((args[0] >= SETTING_ID_MENU_CACHE) && (args[0] < (SETTING_ID_MENU_CACHE + RTC_SETTINGS_MENU_CACHE_WORDS))) {
+                settings.menu_cache[args[0] - SETTING_ID_MENU_CACHE] = args[1];
+                break;
+            }
             return true;
     }
 
@@ -448,9 +482,10 @@ void cfg_reset_state (void) {
 }
 
 void cfg_init (void) {
-    fpga_reg_set(REG_CFG_SCR, CFG_SCR_BOOTLOADER_ENABLED);
+    fpga_reg_set(REG_CFG_SCR, CFG_SCR_BOOTLOADER_WRITE | CFG_SCR_BOOTLOADER_ENABLED);
     cfg_reset_state();
     p.usb_output_ready = true;
+    p.sd_card_request_pending = false;
 }
 
 void cfg_process (void) {
@@ -459,6 +494,10 @@ void cfg_process (void) {
     uint32_t prev_cfg[2];
     usb_tx_info_t packet_info;
 
+    if (p.sd_card_request_pending) {
+        return;
+    }
+
     reg = fpga_reg_get(REG_CFG_CMD);
 
     if (reg & CFG_CMD_PENDING) {
@@ -593,12 +632,8 @@ void cfg_process (void) {
                     cfg_set_error(CFG_ERROR_BAD_ADDRESS);
                     return;
                 }
-                if (sd_read_sectors(args[0], p.sd_card_sector, args[1])) {
-                    cfg_set_error(CFG_ERROR_SD_CARD);
-                    return;
-                }
-                p.sd_card_sector += args[1];
-                break;
+                cfg_sd_card_request(args, false);
+                return;
 
             case 'S':
                 if (args[1] >= 0x800000) {
@@ -609,19 +644,15 @@ void cfg_process (void) {
                     cfg_set_error(CFG_ERROR_BAD_ADDRESS);
                     return;
                 }
-                if (sd_write_sectors(args[0], p.sd_card_sector, args[1])) {
-                    cfg_set_error(CFG_ERROR_SD_CARD);
-                    return;
-                }
-                p.sd_card_sector += args[1];
-                break;
+                cfg_sd_card_request(args, true);
+                return;
 
             case 'D':
-                if (cfg_translate_address(&args[0], args[1], (SDRAM | BRAM))) {
+                if (cfg_translate_address(&args[0], (args[1] & ~(DD_SD_INFO_EXTENTS)), (SDRAM | BRAM))) {
                     cfg_set_error(CFG_ERROR_BAD_ADDRESS);
                     return;
                 }
-                dd_set_sd_info(args[0], args[1]);
+                dd_set_sd_info(args[0], (args[1] & ~(DD_SD_INFO_EXTENTS)), (args[1] & DD_SD_INFO_EXTENTS));
                 break;
 
             case 'W':
@@ -11,10 +11,11 @@
 #define DD_SECTOR_MAX_SIZE          (232)
 #define DD_BLOCK_DATA_SECTORS_NUM   (85)
 #define DD_BLOCK_BUFFER_SIZE        (ALIGN(DD_SECTOR_MAX_SIZE * DD_BLOCK_DATA_SECTORS_NUM, SD_SECTOR_SIZE) + SD_SECTOR_SIZE)
-#define DD_BLOCK_BUFFER_ADDRESS     (0x03BC0000UL - DD_BLOCK_BUFFER_SIZE)
-#define DD_SECTOR_BUFFER_ADDRESS    (0x05002800UL)
+#define DD_BLOCK_BUFFER_ADDRESS(n)  (0x03BC0000UL - (((n) + 1) * DD_BLOCK_BUFFER_SIZE))
+#define DD_BLOCK_BUFFERS            (2)
 #define DD_SD_SECTOR_TABLE_SIZE     (DD_BLOCK_BUFFER_SIZE / SD_SECTOR_SIZE)
 #define DD_SD_MAX_DISKS             (4)
+#define DD_SD_EXTENTS_CACHE_SIZE    (16)
 
 #define DD_DRIVE_ID_RETAIL          (0x0003)
 #define DD_DRIVE_ID_DEVELOPMENT     (0x0004)
@@ -45,8 +46,7 @@ enum state {
     STATE_IDLE,
     STATE_START,
     STATE_BLOCK_READ_WAIT,
-    STATE_SECTOR_READ,
-    STATE_SECTOR_WRITE,
+    STATE_BLOCK_STREAM,
     STATE_BLOCK_WRITE,
     STATE_BLOCK_WRITE_WAIT,
     STATE_NEXT_BLOCK,
@@ -67,6 +67,19 @@ typedef struct {
     uint32_t sector_table_address;
 } sd_disk_info_t;
 
+typedef struct {
+    uint32_t sd_sector;
+    uint32_t count;
+} sd_extent_t;
+
+typedef struct {
+    bool cached;
+    uint16_t index;
+    bool ready;
+    bool valid;
+    uint32_t offset;
+} dd_block_buffer_t;
+
 struct process {
     enum state state;
     rtc_time_t time;
@@ -80,13 +93,17 @@ struct process {
     uint16_t head_track;
     uint8_t current_sector;
     sector_info_t sector_info;
-    bool block_ready;
-    bool block_valid;
-    uint32_t block_offset;
+    dd_block_buffer_t buffers[DD_BLOCK_BUFFERS];
+    uint8_t buffer;
+    bool request_pending;
+    uint8_t request_buffer;
     dd_drive_type_t drive_type;
     bool sd_mode;
     uint8_t sd_current_disk;
     sd_disk_info_t sd_disk_info[DD_SD_MAX_DISKS];
+    bool sd_extents_format;
+    uint8_t sd_extents_cached;
+    sd_extent_t sd_extents[DD_SD_EXTENTS_CACHE_SIZE];
 };
 
 
@@ -100,7 +117,56 @@ static uint16_t dd_track_head_block (void) {
     return (track | head | block);
 }
 
-static uint32_t dd_fill_sd_sector_table (uint32_t index, uint32_t *sector_table) {
+static void dd_load_sd_extents (void) {
+    sd_disk_info_t info = p.sd_disk_info[p.sd_current_disk];
+    p.sd_extents_cached = 0;
+    if (!p.sd_extents_format || (info.sector_table_address == 0xFFFFFFFF)) {
+        return;
+    }
+    fpga_mem_read(info.sector_table_address, sizeof(p.sd_extents), (uint8_t *) (p.sd_extents));
+    for (int i = 0; i < DD_SD_EXTENTS_CACHE_SIZE; i++) {
+        p.sd_extents[i].sd_sector = SWAP32(p.sd_extents[i].sd_sector);
+        p.sd_extents[i].count = SWAP32(p.sd_extents[i].count);
+        if (p.sd_extents[i].count == 0) {
+            break;
+        }
+        p.sd_extents_cached += 1;
+    }
+}
+
+static bool dd_get_sd_extent (uint32_t table_address, uint32_t id, sd_extent_t *extent) {
+    if (id < p.sd_extents_cached) {
+        *extent = p.sd_extents[id];
+        return false;
+    }
+    if (p.sd_extents_cached < DD_SD_EXTENTS_CACHE_SIZE) {
+        return true;
+    }
+    fpga_mem_read(table_address + (id * sizeof(sd_extent_t)), sizeof(sd_extent_t), (uint8_t *) (extent));
+    extent->sd_sector = SWAP32(extent->sd_sector);
+    extent->count = SWAP32(extent->count);
+    return (extent->count == 0);
+}
+
+static uint32_t dd_fill_sd_sector_table_from_extents (uint32_t table_address, uint32_t starting_sector, uint32_t sectors, uint32_t *sector_table) {
+    sd_extent_t extent;
+    uint32_t extent_start = 0;
+    uint32_t filled = 0;
+    for (uint32_t id = 0; filled < sectors; id++) {
+        if (dd_get_sd_extent(table_address, id, &extent)) {
+            return 0;
+        }
+        uint32_t extent_end = (extent_start + extent.count);
+        while ((filled < sectors) && ((starting_sector + filled) < extent_end)) {
+            sector_table[filled] = (extent.sd_sector + ((starting_sector + filled) - extent_start));
+            filled += 1;
+        }
+        extent_start = extent_end;
+    }
+    return sectors;
+}
+
+static uint32_t dd_fill_sd_sector_table (uint32_t index, uint32_t block_length, uint32_t *sector_table, uint32_t *offset) {
     uint32_t tmp;
     sd_disk_info_t info = p.sd_disk_info[p.sd_current_disk];
     if (info.thb_table_address == 0xFFFFFFFF) {
@@ -112,27 +178,38 @@ static uint32_t dd_fill_sd_sector_table (uint32_t index, uint32_t *sector_table)
     if (start_offset == 0xFFFFFFFF) {
         return 0;
     }
-    p.block_offset = (start_offset % SD_SECTOR_SIZE);
-    uint32_t block_length = ((p.sector_info.sector_size + 1) * DD_BLOCK_DATA_SECTORS_NUM);
+    *offset = (start_offset % SD_SECTOR_SIZE);
     uint32_t end_offset = ((start_offset + block_length) - 1);
     uint32_t starting_sector = (start_offset / SD_SECTOR_SIZE);
     uint32_t sectors = (1 + ((end_offset / SD_SECTOR_SIZE) - starting_sector));
+    if (p.sd_extents_format) {
+        return dd_fill_sd_sector_table_from_extents(info.sector_table_address, starting_sector, sectors, sector_table);
+    }
+    uint32_t sector_entry_address = (info.sector_table_address + (starting_sector * sizeof(uint32_t)));
+    fpga_mem_read(sector_entry_address, (sectors * sizeof(uint32_t)), (uint8_t *) (sector_table));
     for (int i = 0; i < sectors; i++) {
-        uint32_t sector_entry_address = info.sector_table_address + ((starting_sector + i) * sizeof(uint32_t));
-        fpga_mem_read(sector_entry_address, sizeof(uint32_t), (uint8_t *) (&tmp));
-        sector_table[i] = SWAP32(tmp);
+        sector_table[i] = SWAP32(sector_table[i]);
     }
     return sectors;
 }
 
-static bool dd_block_read_request (void) {
-    uint16_t index = dd_track_head_block();
-    uint32_t buffer_address = DD_BLOCK_BUFFER_ADDRESS;
+static void dd_sd_request_done (bool error) {
+    dd_set_block_ready(!error);
+}
+
+static bool dd_block_read_request (uint8_t buffer_id, uint16_t index, uint32_t block_length) {
+    dd_block_buffer_t *buffer = &p.buffers[buffer_id];
+    uint32_t buffer_address = DD_BLOCK_BUFFER_ADDRESS(buffer_id);
+    if (p.request_pending) {
+        return false;
+    }
     if (p.sd_mode) {
         uint32_t sector_table[DD_SD_SECTOR_TABLE_SIZE];
-        uint32_t sectors = dd_fill_sd_sector_table(index, sector_table);
-        bool error = sd_optimize_sectors(buffer_address, sector_table, sectors, sd_read_sectors);
-        dd_set_block_ready(!error);
+        uint32_t sectors = dd_fill_sd_sector_table(index, block_length, sector_table, &buffer->offset);
+        buffer->ready = false;
+        p.request_pending = true;
+        p.request_buffer = buffer_id;
+        sd_enqueue_sector_table(buffer_address, sector_table, sectors, false, dd_sd_request_done);
     } else {
         usb_tx_info_t packet_info;
         usb_create_packet(&packet_info, PACKET_CMD_DD_REQUEST);
@@ -140,45 +217,139 @@ static bool dd_block_read_request (void) {
         packet_info.data[0] = 1;
         packet_info.data[1] = buffer_address;
         packet_info.data[2] = index;
-        p.block_ready = false;
-        p.block_offset = 0;
-        return usb_enqueue_packet(&packet_info);
+        if (!usb_enqueue_packet(&packet_info)) {
+            return false;
+        }
+        buffer->ready = false;
+        buffer->offset = 0;
+        p.request_pending = true;
+        p.request_buffer = buffer_id;
     }
+    buffer->cached = true;
+    buffer->index = index;
     return true;
 }
 
 static bool dd_block_write_request (void) {
-    uint32_t index = dd_track_head_block();
-    uint32_t buffer_address = DD_BLOCK_BUFFER_ADDRESS;
+    dd_block_buffer_t *buffer = &p.buffers[p.buffer];
+    uint32_t buffer_address = DD_BLOCK_BUFFER_ADDRESS(p.buffer);
+    uint32_t block_length = ((p.sector_info.sector_size + 1) * DD_BLOCK_DATA_SECTORS_NUM);
+    if (p.request_pending) {
+        return false;
+    }
     if (p.sd_mode) {
         uint32_t sector_table[DD_SD_SECTOR_TABLE_SIZE];
-        uint32_t sectors = dd_fill_sd_sector_table(index, sector_table);
-        bool error = sd_optimize_sectors(buffer_address, sector_table, sectors, sd_write_sectors);
-        dd_set_block_ready(!error);
+        uint32_t sectors = dd_fill_sd_sector_table(buffer->index, block_length, sector_table, &buffer->offset);
+        buffer->ready = false;
+        p.request_pending = true;
+        p.request_buffer = p.buffer;
+        sd_enqueue_sector_table(buffer_address, sector_table, sectors, true, dd_sd_request_done);
     } else {
         usb_tx_info_t packet_info;
         usb_create_packet(&packet_info, PACKET_CMD_DD_REQUEST);
         packet_info.data_length = 12;
         packet_info.data[0] = 2;
         packet_info.data[1] = buffer_address;
-        packet_info.data[2] = index;
-        packet_info.dma_length = (p.sector_info.sector_size + 1) * DD_BLOCK_DATA_SECTORS_NUM;
+        packet_info.data[2] = buffer->index;
+        packet_info.dma_length = block_length;
         packet_info.dma_address = buffer_address;
-        p.block_ready = false;
-        p.block_offset = 0;
-        return usb_enqueue_packet(&packet_info);
+        if (!usb_enqueue_packet(&packet_info)) {
+            return false;
+        }
+        buffer->ready = false;
+        p.request_pending = true;
+        p.request_buffer = p.buffer;
     }
+    buffer->cached = true;
     return true;
 }
 
+static bool dd_block_select (void) {
+    uint16_t index = dd_track_head_block();
+    uint32_t block_length = ((p.sector_info.sector_size + 1) * DD_BLOCK_DATA_SECTORS_NUM);
+    for (int i = 0; i < DD_BLOCK_BUFFERS; i++) {
+        dd_block_buffer_t *buffer = &p.buffers[i];
+        if (buffer->cached && (buffer->index == index)) {
+            if (!p.transfer_mode) {
+                buffer->cached = false;
+            } else if (!buffer->ready || buffer->valid) {
+                p.buffer = i;
+                return true;
+            }
+        }
+    }
+    uint8_t buffer_id = ((p.buffer + 1) % DD_BLOCK_BUFFERS);
+    if (p.request_pending && (p.request_buffer == buffer_id)) {
+        buffer_id = p.buffer;
+    }
+    if (dd_block_read_request(buffer_id, index, block_length)) {
+        p.buffer = buffer_id;
+        return true;
+    }
+    return false;
+}
+
+static void dd_block_prefetch (void) {
+    uint16_t track = (p.head_track & DD_TRACK_MASK);
+    uint16_t index = dd_track_head_block();
+    uint32_t block_length = ((p.sector_info.sector_size + 1) * DD_BLOCK_DATA_SECTORS_NUM);
+
+    if (p.full_track_transfer || (p.starting_block == (track & (1 << 0)))) {
+        index ^= (1 << 0);
+    } else {
+        if (track >= DD_TRACK_MASK) {
+            return;
+        }
+        index += (1 << 2);
+        block_length = (DD_SECTOR_MAX_SIZE * DD_BLOCK_DATA_SECTORS_NUM);
+    }
+
+    for (int i = 0; i < DD_BLOCK_BUFFERS; i++) {
+        dd_block_buffer_t *buffer = &p.buffers[i];
+        if (buffer->cached && (buffer->index == index) && (!buffer->ready || buffer->valid)) {
+            return;
+        }
+    }
+
+    dd_block_read_request(((p.buffer + 1) % DD_BLOCK_BUFFERS), index, block_length);
+}
+
+static void dd_block_buffers_invalidate (void) {
+    for (int i = 0; i < DD_BLOCK_BUFFERS; i++) {
+        p.buffers[i].cached = false;
+    }
+}
+
+static void dd_block_stream_start (bool write) {
+    uint8_t data_sectors = (p.sector_info.sectors_in_block - 4);
+    uint32_t block_regs[2] = {
+        DD_BLOCK_BUFFER_ADDRESS(p.buffer) + p.buffers[p.buffer].offset,
+        (
+            (data_sectors << DD_BLOCK_SCR_SECTORS_BIT) |
+            (p.sector_info.sector_size << DD_BLOCK_SCR_SECTOR_SIZE_BIT) |
+            (write ? DD_BLOCK_SCR_WRITE : 0) |
+            DD_BLOCK_SCR_START
+        )
+    };
+    fpga_reg_set_multiple(REG_DD_BLOCK_ADDRESS, block_regs, 2);
+    p.current_sector = data_sectors;
+}
+
+static void dd_block_stream_stop (void) {
+    fpga_reg_set(REG_DD_BLOCK_SCR, DD_BLOCK_SCR_STOP);
+}
+
 static void dd_set_cmd_response_ready (void) {
     p.cmd_response_ready = true;
 }
 
 
 void dd_set_block_ready (bool valid) {
-    p.block_ready = true;
-    p.block_valid = valid;
+    if (p.request_pending) {
+        p.request_pending = false;
+        p.buffers[p.request_buffer].ready = true;
+        p.buffers[p.request_buffer].valid = valid;
+    }
 }
 
 dd_drive_type_t dd_get_drive_type (void) {
@@ -218,6 +389,7 @@ bool dd_set_disk_state (dd_disk_state_t state) {
     if (state > DD_DISK_STATE_CHANGED) {
         return true;
     }
+    dd_block_buffers_invalidate();
     uint32_t scr = fpga_reg_get(REG_DD_SCR);
     scr &= ~(DD_SCR_DISK_CHANGED | DD_SCR_DISK_INSERTED);
     switch (state) {
@@ -241,13 +413,16 @@ bool dd_get_sd_mode (void) {
 }
 
 void dd_set_sd_mode (bool value) {
+    dd_block_buffers_invalidate();
     p.sd_mode = value;
 }
 
-void dd_set_sd_info (uint32_t address, uint32_t length) {
+void dd_set_sd_info (uint32_t address, uint32_t length, bool extents) {
     sd_disk_info_t info;
+    dd_block_buffers_invalidate();
     length /= sizeof(info);
     p.sd_current_disk = 0;
+    p.sd_extents_format = extents;
     for (int i = 0; i < DD_SD_MAX_DISKS; i++) {
         if (i < length) {
             fpga_mem_read(address, sizeof(info), (uint8_t *) (&info));
@@ -259,6 +434,7 @@ void dd_set_sd_info (uint32_t address, uint32_t length) {
             p.sd_disk_info[i].sector_table_address = 0xFFFFFFFF;
         }
     }
+    dd_load_sd_extents();
 }
 
 void dd_handle_button (void) {
@@ -271,12 +447,17 @@ void dd_handle_button (void) {
             uint8_t sd_next_disk = ((p.sd_current_disk + i + 1) % DD_SD_MAX_DISKS);
             if (p.sd_disk_info[sd_next_disk].thb_table_address != 0xFFFFFFFF) {
                 p.sd_current_disk = sd_next_disk;
+                dd_load_sd_extents();
                 break;
             }
         }
     }
 }
 
+bool dd_is_busy (void) {
+    return (p.bm_running && (p.state != STATE_IDLE));
+}
+
 void dd_init (void) {
     fpga_reg_set(REG_DD_SCR, 0);
     fpga_reg_set(REG_DD_HEAD_TRACK, 0);
@@ -289,7 +470,10 @@ void dd_init (void) {
     p.drive_type = DD_DRIVE_TYPE_RETAIL;
     p.sd_mode = false;
     p.sd_current_disk = 0;
-    dd_set_sd_info(0, 0);
+    p.buffer = 0;
+    p.request_pending = false;
+    dd_set_sd_info(0, 0, false);
+    dd_block_stream_stop();
 }
 
 void dd_process (void) {
@@ -304,6 +488,7 @@ void dd_process (void) {
         p.bm_running = false;
         p.head_track = 0;
         scr &= ~(DD_SCR_DISK_CHANGED);
+        dd_block_stream_stop();
     }
 
     if (scr & DD_SCR_CMD_PENDING) {
@@ -396,7 +581,9 @@ void dd_process (void) {
         scr |= DD_SCR_BM_STOP_CLEAR;
         scr &= ~(DD_SCR_BM_MICRO_ERROR | DD_SCR_BM_TRANSFER_C2 | DD_SCR_BM_TRANSFER_DATA);
         p.bm_running = false;
+        dd_block_stream_stop();
     } else if (scr & DD_SCR_BM_START) {
+        dd_block_stream_stop();
         scr |= DD_SCR_BM_CLEAR | DD_SCR_BM_ACK_CLEAR | DD_SCR_BM_START_CLEAR;
         scr &= ~(DD_SCR_BM_MICRO_ERROR | DD_SCR_BM_TRANSFER_C2 | DD_SCR_BM_TRANSFER_DATA);
         p.state = STATE_START;
@@ -409,9 +596,7 @@ void dd_process (void) {
         if (scr & DD_SCR_BM_PENDING) {
             scr |= DD_SCR_BM_CLEAR;
             if (p.transfer_mode) {
-                if (p.current_sector < (p.sector_info.sectors_in_block - 4)) {
-                    p.state = STATE_SECTOR_READ;
-                } else if (p.current_sector == (p.sector_info.sectors_in_block - 4)) {
+                if (p.current_sector == (p.sector_info.sectors_in_block - 4)) {
                     p.current_sector += 1;
                     scr &= ~(DD_SCR_BM_TRANSFER_DATA);
                     scr |= DD_SCR_BM_READY;
@@ -420,8 +605,8 @@ void dd_process (void) {
                 } else {
                 }
             } else {
-                if (p.current_sector < (p.sector_info.sectors_in_block - 4)) {
-                    p.state = STATE_SECTOR_WRITE;
+                if (p.current_sector == (p.sector_info.sectors_in_block - 4)) {
+                    p.state = STATE_BLOCK_WRITE;
                 }
             }
         }
@@ -449,24 +634,26 @@ void dd_process (void) {
 
             case STATE_START:
                 p.current_sector = 0;
-                if (dd_block_read_request()) {
+                if (dd_block_select()) {
                     p.state = STATE_BLOCK_READ_WAIT;
                 }
                 break;
 
             case STATE_BLOCK_READ_WAIT:
-                if (p.block_ready) {
+                if (p.buffers[p.buffer].ready) {
                     if (p.transfer_mode) {
-                        if (p.block_valid) {
-                            p.state = STATE_SECTOR_READ;
+                        if (p.buffers[p.buffer].valid) {
+                            p.state = STATE_BLOCK_STREAM;
                             scr |= DD_SCR_BM_TRANSFER_DATA;
                         } else {
-                            p.state = STATE_SECTOR_READ;
+                            p.state = STATE_BLOCK_STREAM;
                             scr |= DD_SCR_BM_MICRO_ERROR;
                         }
                     } else {
                         p.state = STATE_IDLE;
-                        if (p.block_valid) {
+                        p.buffers[p.buffer].cached = false;
+                        dd_block_stream_start(true);
+                        if (p.buffers[p.buffer].valid) {
                             scr |= DD_SCR_BM_TRANSFER_DATA | DD_SCR_BM_READY;
                         } else {
                             scr |= DD_SCR_BM_MICRO_ERROR | DD_SCR_BM_READY;
@@ -475,30 +662,10 @@ void dd_process (void) {
                 }
                 break;
 
-            case STATE_SECTOR_READ:
-                fpga_mem_copy(
-                    DD_BLOCK_BUFFER_ADDRESS + p.block_offset + (p.current_sector * (p.sector_info.sector_size + 1)),
-                    DD_SECTOR_BUFFER_ADDRESS,
-                    p.sector_info.sector_size + 1
-                );
+            case STATE_BLOCK_STREAM:
+                dd_block_stream_start(false);
+                dd_block_prefetch();
                 p.state = STATE_IDLE;
-                p.current_sector += 1;
-                scr |= DD_SCR_BM_READY;
-                break;
-
-            case STATE_SECTOR_WRITE:
-                fpga_mem_copy(
-                    DD_SECTOR_BUFFER_ADDRESS,
-                    DD_BLOCK_BUFFER_ADDRESS + p.block_offset + (p.current_sector * (p.sector_info.sector_size + 1)),
-                    p.sector_info.sector_size + 1
-                );
-                p.current_sector += 1;
-                if (p.current_sector < (p.sector_info.sectors_in_block - 4)) {
-                    p.state = STATE_IDLE;
-                    scr |= DD_SCR_BM_READY;
-                } else {
-                    p.state = STATE_BLOCK_WRITE;
-                }
                 break;
 
             case STATE_BLOCK_WRITE:
@@ -508,7 +675,7 @@ void dd_process (void) {
                 break;
 
             case STATE_BLOCK_WRITE_WAIT:
-                if (p.block_ready) {
+                if (p.buffers[p.buffer].ready) {
                     p.state = STATE_NEXT_BLOCK;
                 }
                 break;
@@ -6,6 +6,9 @@
 #include <stdint.h>
 
 
+#define DD_SD_INFO_EXTENTS  (1UL << 31)
+
+
 typedef enum {
     DD_DRIVE_TYPE_RETAIL = 0,
     DD_DRIVE_TYPE_DEVELOPMENT = 1,
@@ -25,8 +28,9 @@ dd_disk_state_t dd_get_disk_state (void);
 bool dd_set_disk_state (dd_disk_state_t state);
 bool dd_get_sd_mode (void);
 void dd_set_sd_mode (bool value);
-void dd_set_sd_info (uint32_t address, uint32_t length);
+void dd_set_sd_info (uint32_t address, uint32_t length, bool extents);
 void dd_handle_button (void);
+bool dd_is_busy (void);
 void dd_init (void);
 void dd_process (void);
 
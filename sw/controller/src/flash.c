@@ -14,13 +14,7 @@ bool flash_program (uint32_t src, uint32_t dst, uint32_t length) {
     if ((dst < FLASH_ADDRESS) || ((dst + length) >= (FLASH_ADDRESS + FLASH_SIZE))) {
         return true;
     }
-    while (length > 0) {
-        uint32_t block = (length > FPGA_MAX_MEM_TRANSFER) ? FPGA_MAX_MEM_TRANSFER : length;
-        fpga_mem_copy(src, dst, block);
-        src += block;
-        dst += block;
-        length -= block;
-    }
+    fpga_mem_copy(src, dst, length);
     return false;
 }
 
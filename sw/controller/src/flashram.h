@@ -1,9 +0,0 @@
-#ifndef FLASHRAM_H__
-#define FLASHRAM_H__
-
-
-void flashram_init (void);
-void flashram_process (void);
-
-
-#endif
@@ -2,6 +2,91 @@
 #include "hw.h"
 
 
+typedef struct {
+    fpga_reg_t reg;
+    uint32_t mask;
+} fpga_shadow_reg_t;
+
+
+static const fpga_shadow_reg_t shadow_regs[] = {
+    { REG_MEM_ADDRESS, 0xFFFFFFFF },
+    { REG_USB_DMA_ADDRESS, 0x07FFFFFF },
+    { REG_USB_DMA_LENGTH, 0x07FFFFFF },
+    { REG_CFG_SCR, CFG_SCR_MCU_OWNED_MASK },
+    { REG_SD_ARG, 0xFFFFFFFF },
+    { REG_SD_DMA_ADDRESS, 0x07FFFFFF },
+    { REG_SD_DMA_LENGTH, 0x07FFFFFF },
+};
+
+#define SHADOW_REGS_COUNT   (sizeof(shadow_regs) / sizeof(shadow_regs[0]))
+
+#define SPI_ASYNC_MIN_LENGTH    (64)
+
+static uint32_t shadow_values[SHADOW_REGS_COUNT];
+static uint32_t shadow_valid = 0;
+
+static uint32_t spi_saved_counter = 0;
+static uint32_t spi_saved_last = 0;
+
+static bool copy_crc32_pending = false;
+static uint32_t copy_crc32_result = 0;
+
+static void (*spi_wait_handler)(volatile bool *done) = 0;
+static void (*spi_wakeup_handler)(void) = 0;
+static volatile bool spi_dma_done;
+
+
+static int fpga_shadow_index (fpga_reg_t reg) {
+    for (int i = 0; i < SHADOW_REGS_COUNT; i++) {
+        if (shadow_regs[i].reg == reg) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void fpga_shadow_update (fpga_reg_t reg, uint32_t value) {
+    int index = fpga_shadow_index(reg);
+    if (index >= 0) {
+        shadow_values[index] = (value & shadow_regs[index].mask);
+        shadow_valid |= (1 << index);
+    }
+}
+
+static bool fpga_shadow_hit (fpga_reg_t reg, uint32_t value) {
+    int index = fpga_shadow_index(reg);
+    if ((index < 0) || (!(shadow_valid & (1 << index)))) {
+        return false;
+    }
+    if ((reg == REG_CFG_SCR) && (value & CFG_SCR_BOOTLOADER_WRITE)) {
+        return false;
+    }
+    return (shadow_values[index] == (value & shadow_regs[index].mask));
+}
+
+static void fpga_spi_dma_done (void) {
+    spi_dma_done = true;
+    if (spi_wakeup_handler) {
+        spi_wakeup_handler();
+    }
+}
+
+static void fpga_spi_trx_data (uint8_t *data, size_t length, spi_direction_t direction) {
+    if ((spi_wait_handler == 0) || (length < SPI_ASYNC_MIN_LENGTH)) {
+        hw_spi_trx(data, length, direction);
+        return;
+    }
+    spi_dma_done = false;
+    hw_spi_trx_async(data, length, direction, fpga_spi_dma_done);
+    spi_wait_handler(&spi_dma_done);
+}
+
+
+void fpga_set_wait_handler (void (*wait)(volatile bool *done), void (*wakeup)(void)) {
+    spi_wait_handler = wait;
+    spi_wakeup_handler = wakeup;
+}
+
 uint8_t fpga_id_get (void) {
     fpga_cmd_t cmd = CMD_IDENTIFY;
     uint8_t id;
@@ -15,26 +100,69 @@ uint8_t fpga_id_get (void) {
 }
 
 uint32_t fpga_reg_get (fpga_reg_t reg) {
-    fpga_cmd_t cmd = CMD_REG_READ;
     uint32_t value;
+    fpga_reg_get_multiple(reg, &value, 1);
+    return value;
+}
+
+void fpga_reg_set (fpga_reg_t reg, uint32_t value) {
+    if (fpga_shadow_hit(reg, value)) {
+        spi_saved_counter += 1;
+        return;
+    }
+    fpga_reg_set_multiple(reg, &value, 1);
+}
+
+void fpga_reg_get_multiple (fpga_reg_t reg, uint32_t *values, size_t count) {
+    fpga_cmd_t cmd = CMD_REG_READ;
+    uint8_t address = reg;
 
     hw_spi_start();
     hw_spi_trx((uint8_t *) (&cmd), 1, SPI_TX);
-    hw_spi_trx(&reg, 1, SPI_TX);
-    hw_spi_trx((uint8_t *) (&value), 4, SPI_RX);
+    hw_spi_trx(&address, 1, SPI_TX);
+    hw_spi_trx((uint8_t *) (values), (count * 4), SPI_RX);
     hw_spi_stop();
 
-    return value;
+    spi_saved_counter += (count - 1);
 }
 
-void fpga_reg_set (fpga_reg_t reg, uint32_t value) {
+void fpga_reg_set_multiple (fpga_reg_t reg, uint32_t *values, size_t count) {
     fpga_cmd_t cmd = CMD_REG_WRITE;
+    uint8_t address = reg;
 
     hw_spi_start();
     hw_spi_trx((uint8_t *) (&cmd), 1, SPI_TX);
-    hw_spi_trx(&reg, 1, SPI_TX);
-    hw_spi_trx((uint8_t *) (&value), 4, SPI_TX);
+    hw_spi_trx(&address, 1, SPI_TX);
+    hw_spi_trx((uint8_t *) (values), (count * 4), SPI_TX);
     hw_spi_stop();
+
+    for (size_t i = 0; i < count; i++) {
+        fpga_shadow_update(reg + i, values[i]);
+    }
+
+    spi_saved_counter += (count - 1);
+}
+
+uint32_t fpga_reg_get_shadow (fpga_reg_t reg) {
+    int index = fpga_shadow_index(reg);
+    if (index < 0) {
+        return fpga_reg_get(reg);
+    }
+    if (!(shadow_valid & (1 << index))) {
+        fpga_shadow_update(reg, fpga_reg_get(reg));
+    } else {
+        spi_saved_counter += 1;
+    }
+    return shadow_values[index];
+}
+
+void fpga_spi_saved_update (void) {
+    spi_saved_last = spi_saved_counter;
+    spi_saved_counter = 0;
+}
+
+uint32_t fpga_spi_saved_get (void) {
+    return spi_saved_last;
 }
 
 void fpga_mem_read (uint32_t address, size_t length, uint8_t *buffer) {
@@ -45,14 +173,15 @@ void fpga_mem_read (uint32_t address, size_t length, uint8_t *buffer) {
         dma_length += 1;
     }
 
-    fpga_reg_set(REG_MEM_ADDRESS, address);
-    fpga_reg_set(REG_MEM_SCR, (dma_length << MEM_SCR_LENGTH_BIT) | MEM_SCR_START);
+    uint32_t mem_regs[2] = { address, (dma_length << MEM_SCR_LENGTH_BIT) | MEM_SCR_START };
+
+    fpga_reg_set_multiple(REG_MEM_ADDRESS, mem_regs, 2);
     while (fpga_reg_get(REG_MEM_SCR) & MEM_SCR_BUSY);
 
     hw_spi_start();
     hw_spi_trx((uint8_t *) (&cmd), 1, SPI_TX);
     hw_spi_trx(&buffer_address, 1, SPI_TX);
-    hw_spi_trx(buffer, length, SPI_RX);
+    fpga_spi_trx_data(buffer, length, SPI_RX);
     hw_spi_stop();
 }
 
@@ -67,27 +196,68 @@ void fpga_mem_write (uint32_t address, size_t length, uint8_t *buffer) {
     hw_spi_start();
     hw_spi_trx((uint8_t *) (&cmd), 1, SPI_TX);
     hw_spi_trx(&buffer_address, 1, SPI_TX);
-    hw_spi_trx(buffer, length, SPI_TX);
+    fpga_spi_trx_data(buffer, length, SPI_TX);
     hw_spi_stop();
 
-    fpga_reg_set(REG_MEM_ADDRESS, address);
-    fpga_reg_set(REG_MEM_SCR, (dma_length << MEM_SCR_LENGTH_BIT) | MEM_SCR_DIRECTION | MEM_SCR_START);
+    uint32_t mem_regs[2] = { address, (dma_length << MEM_SCR_LENGTH_BIT) | MEM_SCR_DIRECTION | MEM_SCR_START };
+
+    fpga_reg_set_multiple(REG_MEM_ADDRESS, mem_regs, 2);
     while (fpga_reg_get(REG_MEM_SCR) & MEM_SCR_BUSY);
 }
 
-void fpga_mem_copy (uint32_t src, uint32_t dst, size_t length) {
-    size_t dma_length = length;
-    if ((dma_length % 2) != 0) {
-        dma_length += 1;
+static void fpga_mem_copy_claim (void) {
+    while (fpga_mem_copy_busy());
+    if (copy_crc32_pending) {
+        copy_crc32_pending = false;
+        copy_crc32_result = fpga_reg_get(REG_COPY_CRC32);
     }
+}
 
-    fpga_reg_set(REG_MEM_ADDRESS, src);
-    fpga_reg_set(REG_MEM_SCR, (dma_length << MEM_SCR_LENGTH_BIT) | MEM_SCR_START);
-    while (fpga_reg_get(REG_MEM_SCR) & MEM_SCR_BUSY);
+void fpga_mem_copy (uint32_t src, uint32_t dst, size_t length) {
+    uint32_t copy_regs[4] = { src, dst, length, COPY_SCR_START };
 
-    fpga_reg_set(REG_MEM_ADDRESS, dst);
-    fpga_reg_set(REG_MEM_SCR, (dma_length << MEM_SCR_LENGTH_BIT) | MEM_SCR_DIRECTION | MEM_SCR_START);
-    while (fpga_reg_get(REG_MEM_SCR) & MEM_SCR_BUSY);
+    fpga_mem_copy_claim();
+    fpga_reg_set_multiple(REG_COPY_SOURCE, copy_regs, 4);
+    while (fpga_mem_copy_busy());
+}
+
+bool fpga_mem_copy_busy (void) {
+    return (fpga_reg_get(REG_COPY_SCR) & COPY_SCR_BUSY);
+}
+
+void fpga_mem_fill_start (uint32_t address, size_t length, uint8_t value) {
+    uint32_t fill_data = ((value << 8) | value);
+    uint32_t copy_regs[3] = { address, length, (fill_data << COPY_SCR_FILL_DATA_BIT) | COPY_SCR_FILL | COPY_SCR_START };
+
+    fpga_mem_copy_claim();
+    fpga_reg_set_multiple(REG_COPY_DESTINATION, copy_regs, 3);
+}
+
+void fpga_mem_fill (uint32_t address, size_t length, uint8_t value) {
+    fpga_mem_fill_start(address, length, value);
+    while (fpga_mem_copy_busy());
+}
+
+void fpga_mem_crc32_start (uint32_t address, size_t length) {
+    uint32_t copy_regs[4] = { address, 0, length, COPY_SCR_CRC32 | COPY_SCR_START };
+
+    fpga_mem_copy_claim();
+    fpga_reg_set_multiple(REG_COPY_SOURCE, copy_regs, 4);
+    copy_crc32_pending = true;
+}
+
+uint32_t fpga_mem_crc32_result (void) {
+    if (copy_crc32_pending) {
+        copy_crc32_pending = false;
+        copy_crc32_result = fpga_reg_get(REG_COPY_CRC32);
+    }
+    return copy_crc32_result;
+}
+
+uint32_t fpga_mem_crc32 (uint32_t address, size_t length) {
+    fpga_mem_crc32_start(address, length);
+    while (fpga_mem_copy_busy());
+    return fpga_mem_crc32_result();
 }
 
 uint8_t fpga_usb_status_get (void) {
@@ -122,3 +292,38 @@ void fpga_usb_push (uint8_t data) {
     hw_spi_trx(&data, 1, SPI_TX);
     hw_spi_stop();
 }
+
+size_t fpga_usb_read_burst (uint8_t *buffer, size_t length) {
+    fpga_cmd_t cmd = CMD_USB_READ_BURST;
+    uint8_t max_count = (length > FPGA_MAX_USB_BURST) ? FPGA_MAX_USB_BURST : length;
+    uint8_t count;
+
+    hw_spi_start();
+    hw_spi_trx((uint8_t *) (&cmd), 1, SPI_TX);
+    hw_spi_trx(&max_count, 1, SPI_TX);
+    hw_spi_trx(&count, 1, SPI_RX);
+    if (count > 0) {
+        fpga_spi_trx_data(buffer, count, SPI_RX);
+    }
+    hw_spi_stop();
+
+    return count;
+}
+
+size_t fpga_usb_write_burst (uint8_t *buffer, size_t length) {
+    fpga_cmd_t cmd = CMD_USB_WRITE_BURST;
+    uint8_t free;
+
+    hw_spi_start();
+    hw_spi_trx((uint8_t *) (&cmd), 1, SPI_TX);
+    hw_spi_trx(&free, 1, SPI_RX);
+    if (length > free) {
+        length = free;
+    }
+    if (length > 0) {
+        fpga_spi_trx_data(buffer, length, SPI_TX);
+    }
+    hw_spi_stop();
+
+    return length;
+}
@@ -2,6 +2,7 @@
 #define FPGA_H__
 
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -14,7 +15,9 @@ typedef enum {
     CMD_MEM_WRITE,
     CMD_USB_STATUS,
     CMD_USB_READ,
-    CMD_USB_WRITE
+    CMD_USB_WRITE,
+    CMD_USB_READ_BURST,
+    CMD_USB_WRITE_BURST
 } fpga_cmd_t;
 
 typedef enum {
@@ -55,6 +58,22 @@ typedef enum {
     REG_VENDOR_DATA,
     REG_DEBUG_0,
     REG_DEBUG_1,
+    REG_EVENTS,
+    REG_COPY_SOURCE,
+    REG_COPY_DESTINATION,
+    REG_COPY_LENGTH,
+    REG_COPY_SCR,
+    REG_COPY_CRC32,
+    REG_DD_BLOCK_ADDRESS,
+    REG_DD_BLOCK_SCR,
+    REG_SAVE_DIRTY_0,
+    REG_SAVE_DIRTY_1,
+    REG_SAVE_DIRTY_2,
+    REG_SAVE_DIRTY_3,
+    REG_SAVE_DIRTY_4,
+    REG_SAVE_DIRTY_5,
+    REG_SAVE_DIRTY_6,
+    REG_SAVE_DIRTY_7,
 } fpga_reg_t;
 
 
@@ -65,6 +84,7 @@ typedef enum {
 #define FPGA_ID                         (0x64)
 
 #define FPGA_MAX_MEM_TRANSFER           (1024)
+#define FPGA_MAX_USB_BURST              (255)
 
 #define USB_STATUS_RXNE                 (1 << 0)
 #define USB_STATUS_TXE                  (1 << 1)
@@ -93,6 +113,13 @@ typedef enum {
 #define DMA_SCR_DIRECTION               (1 << 2)
 #define DMA_SCR_BUSY                    (1 << 3)
 
+#define COPY_SCR_START                  (1 << 0)
+#define COPY_SCR_STOP                   (1 << 1)
+#define COPY_SCR_FILL                   (1 << 2)
+#define COPY_SCR_BUSY                   (1 << 3)
+#define COPY_SCR_CRC32                  (1 << 4)
+#define COPY_SCR_FILL_DATA_BIT          (16)
+
 #define CFG_SCR_BOOTLOADER_ENABLED      (1 << 0)
 #define CFG_SCR_BOOTLOADER_SKIP         (1 << 1)
 #define CFG_SCR_ROM_WRITE_ENABLED       (1 << 2)
@@ -105,6 +132,8 @@ typedef enum {
 #define CFG_SCR_EEPROM_ENABLED          (1 << 9)
 #define CFG_SCR_EEPROM_16K              (1 << 10)
 #define CFG_SCR_ROM_EXTENDED_ENABLED    (1 << 11)
+#define CFG_SCR_BOOTLOADER_WRITE        (1 << 12)
+#define CFG_SCR_MCU_OWNED_MASK          (0x00000FFE)
 #define CFG_SCR_BUTTON_STATE            (1 << 31)
 
 #define CFG_CMD_BIT                     (0)
@@ -114,7 +143,6 @@ typedef enum {
 #define CFG_CMD_ERROR                   (1 << 10)
 #define CFG_CMD_IRQ                     (1 << 11)
 
-#define FLASHRAM_SCR_DONE               (1 << 0)
 #define FLASHRAM_SCR_PENDING            (1 << 1)
 #define FLASHRAM_SCR_PAGE_BIT           (2)
 #define FLASHRAM_SCR_PAGE_MASK          (0x3FF << FLASHRAM_SCR_PAGE_BIT)
@@ -158,6 +186,7 @@ typedef enum {
 #define SD_DAT_BLOCKS_MASK              (0xFF << SD_DAT_BLOCKS_BIT)
 #define SD_DAT_BUSY                     (1 << 12)
 #define SD_DAT_ERROR                    (1 << 13)
+#define SD_DAT_STREAM                   (1 << 14)
 
 #define DD_SCR_HARD_RESET               (1 << 0)
 #define DD_SCR_HARD_RESET_CLEAR         (1 << 1)
@@ -185,16 +214,51 @@ typedef enum {
 #define DD_HEAD_TRACK_MASK              (DD_HEAD_MASK | DD_TRACK_MASK)
 #define DD_HEAD_TRACK_INDEX_LOCK        (1 << 13)
 
+#define DD_BLOCK_SCR_START              (1 << 0)
+#define DD_BLOCK_SCR_STOP               (1 << 1)
+#define DD_BLOCK_SCR_WRITE              (1 << 2)
+#define DD_BLOCK_SCR_ACTIVE             (1 << 3)
+#define DD_BLOCK_SCR_SECTOR_SIZE_BIT    (8)
+#define DD_BLOCK_SCR_SECTORS_BIT        (16)
+#define DD_BLOCK_SCR_CURRENT_SECTOR_BIT (24)
+
+#define EVENT_CFG_CMD                   (1 << 0)
+#define EVENT_DD                        (1 << 1)
+#define EVENT_RTC                       (1 << 3)
+#define EVENT_USB_RX                    (1 << 4)
+#define EVENT_USB_STATUS                (1 << 5)
+#define EVENT_USB_DMA                   (1 << 6)
+#define EVENT_SAVE_COUNT                (1 << 7)
+#define EVENT_BUTTON                    (1 << 8)
+#define EVENT_SD_DET                    (1 << 9)
+#define EVENT_PENDING_MASK              (0x3FF)
+#define EVENT_LATCHED_MASK              (0x3E0)
+#define EVENT_ENABLE_BIT                (16)
+
 
+void fpga_set_wait_handler (void (*wait)(volatile bool *done), void (*wakeup)(void));
 uint8_t fpga_id_get (void);
 uint32_t fpga_reg_get (fpga_reg_t reg);
 void fpga_reg_set (fpga_reg_t reg, uint32_t value);
+void fpga_reg_get_multiple (fpga_reg_t reg, uint32_t *values, size_t count);
+void fpga_reg_set_multiple (fpga_reg_t reg, uint32_t *values, size_t count);
+uint32_t fpga_reg_get_shadow (fpga_reg_t reg);
+void fpga_spi_saved_update (void);
+uint32_t fpga_spi_saved_get (void);
 void fpga_mem_read (uint32_t address, size_t length, uint8_t *buffer);
 void fpga_mem_write (uint32_t address, size_t length, uint8_t *buffer);
 void fpga_mem_copy (uint32_t src, uint32_t dst, size_t length);
+bool fpga_mem_copy_busy (void);
+void fpga_mem_fill_start (uint32_t address, size_t length, uint8_t value);
+void fpga_mem_fill (uint32_t address, size_t length, uint8_t value);
+void fpga_mem_crc32_start (uint32_t address, size_t length);
+uint32_t fpga_mem_crc32_result (void);
+uint32_t fpga_mem_crc32 (uint32_t address, size_t length);
 uint8_t fpga_usb_status_get (void);
 uint8_t fpga_usb_pop (void);
 void fpga_usb_push (uint8_t data);
+size_t fpga_usb_read_burst (uint8_t *buffer, size_t length);
+size_t fpga_usb_write_burst (uint8_t *buffer, size_t length);
 
 
 #endif
@@ -1,36 +1,113 @@
 #include "button.h"
 #include "cfg.h"
 #include "dd.h"
-#include "flashram.h"
 #include "fpga.h"
+#include "hw.h"
 #include "isv.h"
+#include "profile.h"
 #include "rtc.h"
 #include "sd.h"
+#include "task.h"
 #include "usb.h"
 #include "writeback.h"
 
 
+#define GVR_EVENTS_ENABLED  (EVENT_PENDING_MASK)
+#define GVR_IDLE_TIMEOUT_MS (10)
+
+
+static volatile bool gvr_event_pending = false;
+static volatile uint32_t gvr_event_timestamp = 0;
+
+
+static void gvr_event_irq (void) {
+    if (!gvr_event_pending) {
+        gvr_event_timestamp = task_get_cycles();
+    }
+    gvr_event_pending = true;
+    task_set_ready(TASK_ID_GVR);
+}
+
+static void gvr_fpga_wait (volatile bool *done) {
+    while (task_wait(done, GVR_IDLE_TIMEOUT_MS));
+}
+
+static void gvr_fpga_wakeup (void) {
+    task_set_ready(TASK_ID_GVR);
+}
+
+static bool gvr_is_busy (void) {
+    return (
+        button_is_busy() ||
+        dd_is_busy() ||
+        (isv_get_address() != 0) ||
+        rtc_is_busy() ||
+        sd_is_busy() ||
+        usb_is_busy() ||
+        writeback_is_busy()
+    );
+}
+
+
 void gvr_task (void) {
     while (fpga_id_get() != FPGA_ID);
 
+    fpga_set_wait_handler(gvr_fpga_wait, gvr_fpga_wakeup);
+
     button_init();
     cfg_init();
     dd_init();
-    flashram_init();
     isv_init();
     sd_init();
     usb_init();
     writeback_init();
 
+    hw_gpio_irq_setup(GPIO_ID_FPGA_INT, GPIO_IRQ_RISING, gvr_event_irq);
+    fpga_reg_set(REG_EVENTS, (GVR_EVENTS_ENABLED << EVENT_ENABLE_BIT) | EVENT_LATCHED_MASK);
+
     while (1) {
-        button_process();
-        cfg_process();
-        dd_process();
-        flashram_process();
-        isv_process();
-        rtc_process();
-        sd_process();
-        usb_process();
-        writeback_process();
+        uint32_t timestamp = gvr_event_pending ? gvr_event_timestamp : task_get_cycles();
+
+        gvr_event_pending = false;
+
+        uint32_t events = (fpga_reg_get(REG_EVENTS) & EVENT_PENDING_MASK);
+
+        if (events & EVENT_LATCHED_MASK) {
+            fpga_reg_set(REG_EVENTS, (GVR_EVENTS_ENABLED << EVENT_ENABLE_BIT) | (events & EVENT_LATCHED_MASK));
+        }
+
+        profile_latency_track(PROFILE_LATENCY_CFG, (events & EVENT_CFG_CMD), timestamp);
+        profile_latency_track(PROFILE_LATENCY_DD, (events & EVENT_DD), timestamp);
+
+        if ((events & EVENT_BUTTON) || button_is_busy()) {
+            profile_process_run(PROFILE_PROCESS_BUTTON, button_process);
+        }
+        if (events & EVENT_CFG_CMD) {
+            profile_process_run(PROFILE_PROCESS_CFG, cfg_process);
+            profile_latency_served(PROFILE_LATENCY_CFG);
+        }
+        if ((events & EVENT_DD) || dd_is_busy()) {
+            profile_process_run(PROFILE_PROCESS_DD, dd_process);
+            profile_latency_served(PROFILE_LATENCY_DD);
+        }
+        profile_process_run(PROFILE_PROCESS_ISV, isv_process);
+        if ((events & EVENT_RTC) || rtc_is_busy()) {
+            profile_process_run(PROFILE_PROCESS_RTC, rtc_process);
+        }
+        if ((events & EVENT_SD_DET) || sd_is_busy()) {
+            profile_process_run(PROFILE_PROCESS_SD, sd_process);
+        }
+        if ((events & (EVENT_USB_RX | EVENT_USB_STATUS | EVENT_USB_DMA)) || usb_is_busy()) {
+            profile_process_run(PROFILE_PROCESS_USB, usb_process);
+        }
+        if ((events & (EVENT_SAVE_COUNT | EVENT_SD_DET)) || writeback_is_busy()) {
+            profile_process_run(PROFILE_PROCESS_WRITEBACK, writeback_process);
+        }
+
+        fpga_spi_saved_update();
+
+        if (!events && !gvr_is_busy()) {
+            task_wait(&gvr_event_pending, GVR_IDLE_TIMEOUT_MS);
+        }
     }
 }
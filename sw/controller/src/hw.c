@@ -55,6 +55,8 @@ static volatile uint8_t *i2c_data_txptr;
 static volatile uint8_t *i2c_data_rxptr;
 static volatile uint32_t i2c_next_cr2;
 static void (*volatile i2c_callback)(void);
+static volatile uint8_t spi_dummy __attribute__((unused));
+static void (*volatile spi_callback)(void);
 static const TIM_TypeDef *tims[] = { TIM14, TIM16, TIM17, TIM3, TIM1 };
 static void (*volatile tim_callbacks[5])(void);
 
@@ -139,25 +141,27 @@ void hw_spi_stop (void) {
     hw_gpio_set(GPIO_ID_SPI_CS);
 }
 
-void hw_spi_trx (uint8_t *data, int length, spi_direction_t direction) {
-    volatile uint8_t dummy __attribute__((unused));
-
+static void hw_spi_dma_start (uint8_t *data, int length, spi_direction_t direction, uint32_t rx_flags) {
     DMA1_Channel1->CNDTR = length;
     DMA1_Channel2->CNDTR = length;
 
     if (direction == SPI_TX) {
-        DMA1_Channel1->CMAR = (uint32_t) (&dummy);
-        DMA1_Channel1->CCR = DMA_CCR_EN;
+        DMA1_Channel1->CMAR = (uint32_t) (&spi_dummy);
+        DMA1_Channel1->CCR = (rx_flags | DMA_CCR_EN);
 
         DMA1_Channel2->CMAR = (uint32_t) (data);
         DMA1_Channel2->CCR = (DMA_CCR_MINC | DMA_CCR_DIR | DMA_CCR_EN);
     } else {
         DMA1_Channel1->CMAR = (uint32_t) (data);
-        DMA1_Channel1->CCR = (DMA_CCR_MINC | DMA_CCR_EN);
+        DMA1_Channel1->CCR = (rx_flags | DMA_CCR_MINC | DMA_CCR_EN);
 
-        DMA1_Channel2->CMAR = (uint32_t) (&dummy);
+        DMA1_Channel2->CMAR = (uint32_t) (&spi_dummy);
         DMA1_Channel2->CCR = (DMA_CCR_DIR | DMA_CCR_EN);
     }
+}
+
+void hw_spi_trx (uint8_t *data, int length, spi_direction_t direction) {
+    hw_spi_dma_start(data, length, direction, 0);
 
     while (DMA1_Channel1->CNDTR || DMA1_Channel2->CNDTR);
 
@@ -165,6 +169,12 @@ void hw_spi_trx (uint8_t *data, int length, spi_direction_t direction) {
     DMA1_Channel2->CCR = 0;
 }
 
+void hw_spi_trx_async (uint8_t *data, int length, spi_direction_t direction, void (*callback)(void)) {
+    spi_callback = callback;
+    DMA1->IFCR = DMA_IFCR_CGIF1;
+    hw_spi_dma_start(data, length, direction, DMA_CCR_TCIE);
+}
+
 void hw_i2c_read (uint8_t i2c_address, uint8_t address, uint8_t *data, uint8_t length, void (*callback)(void)) {
     i2c_data_rxptr = data;
     i2c_callback = callback;
@@ -315,9 +325,14 @@ void hw_tim_enable_irq (tim_id_t id) {
 }
 
 void hw_delay_ms (uint32_t ms) {
-    SysTick->VAL = 0;
-    for (uint32_t i = 0; i < ms; i++) {
-        while (!(SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk));
+    uint32_t reload = (SysTick->LOAD + 1);
+    uint32_t remaining = (ms * reload);
+    uint32_t last = SysTick->VAL;
+    while (remaining > 0) {
+        uint32_t value = SysTick->VAL;
+        uint32_t elapsed = ((last >= value) ? (last - value) : ((last + reload) - value));
+        last = value;
+        remaining = ((elapsed >= remaining) ? 0 : (remaining - elapsed));
     }
 }
 
@@ -531,6 +546,7 @@ void hw_init (void) {
     NVIC_SetPriority(EXTI2_3_IRQn, 1);
     NVIC_SetPriority(EXTI4_15_IRQn, 2);
     NVIC_SetPriority(I2C1_IRQn, 1);
+    NVIC_SetPriority(DMA1_Channel1_IRQn, 1);
     NVIC_SetPriority(TIM14_IRQn, 0);
     NVIC_SetPriority(TIM16_IRQn, 1);
     NVIC_SetPriority(TIM17_IRQn, 2);
@@ -541,6 +557,7 @@ void hw_init (void) {
     NVIC_EnableIRQ(EXTI2_3_IRQn);
     NVIC_EnableIRQ(EXTI4_15_IRQn);
     NVIC_EnableIRQ(I2C1_IRQn);
+    NVIC_EnableIRQ(DMA1_Channel1_IRQn);
     NVIC_EnableIRQ(TIM14_IRQn);
     NVIC_EnableIRQ(TIM16_IRQn);
     NVIC_EnableIRQ(TIM17_IRQn);
@@ -635,6 +652,17 @@ void I2C1_IRQHandler (void) {
     }
 }
 
+void DMA1_Channel1_IRQHandler (void) {
+    if (DMA1->ISR & DMA_ISR_TCIF1) {
+        DMA1->IFCR = DMA_IFCR_CGIF1;
+        DMA1_Channel1->CCR = 0;
+        DMA1_Channel2->CCR = 0;
+        if (spi_callback) {
+            spi_callback();
+        }
+    }
+}
+
 void TIM14_IRQHandler (void) {
     TIM14->SR &= ~(TIM_SR_UIF);
     if (tim_callbacks[0]) {
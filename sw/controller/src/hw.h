@@ -2,6 +2,7 @@
 #define HW_H__
 
 
+#include <stdbool.h>
 #include <stdint.h>
 
 
@@ -69,6 +70,7 @@ void hw_uart_wait_busy (void);
 void hw_spi_start (void);
 void hw_spi_stop (void);
 void hw_spi_trx (uint8_t *data, int length, spi_direction_t direction);
+void hw_spi_trx_async (uint8_t *data, int length, spi_direction_t direction, void (*callback)(void));
 void hw_i2c_read (uint8_t i2c_address, uint8_t address, uint8_t *data, uint8_t length, void (*callback)(void));
 void hw_i2c_write (uint8_t i2c_address, uint8_t address, uint8_t *data, uint8_t length, void (*callback)(void));
 uint32_t hw_i2c_get_error (void);
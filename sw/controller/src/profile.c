@@ -0,0 +1,123 @@
+#include "fpga.h"
+#include "profile.h"
+#include "task.h"
+
+
+#define PROFILE_CLOCK_FREQUENCY     (64000000UL)
+#define PROFILE_TASK_COUNT          (__TASK_ID_MAX)
+#define PROFILE_DATA_WORDS          (6 + (PROFILE_TASK_COUNT * 2) + ((__PROFILE_PROCESS_COUNT + __PROFILE_LATENCY_COUNT) * 4))
+
+
+typedef struct {
+    uint32_t count;
+    uint64_t total;
+    uint32_t max;
+} profile_stats_t;
+
+typedef struct {
+    bool active;
+    uint32_t start;
+    uint32_t served;
+} profile_request_t;
+
+
+static uint64_t task_baseline[PROFILE_TASK_COUNT];
+static profile_stats_t process_stats[__PROFILE_PROCESS_COUNT];
+static profile_stats_t latency_stats[__PROFILE_LATENCY_COUNT];
+static profile_request_t latency_requests[__PROFILE_LATENCY_COUNT];
+
+
+static void profile_stats_add (profile_stats_t *stats, uint32_t cycles) {
+    stats->count += 1;
+    stats->total += cycles;
+    if (cycles > stats->max) {
+        stats->max = cycles;
+    }
+}
+
+static uint32_t *profile_stats_put (uint32_t *data, profile_stats_t *stats) {
+    *data++ = stats->count;
+    *data++ = (uint32_t) (stats->total);
+    *data++ = (uint32_t) (stats->total >> 32);
+    *data++ = stats->max;
+    return data;
+}
+
+
+void profile_process_run (profile_process_t id, void (*process)(void)) {
+    uint32_t start = task_get_cycles();
+    process();
+    profile_stats_add(&process_stats[id], task_get_cycles() - start);
+}
+
+void profile_latency_track (profile_latency_t id, bool pending, uint32_t timestamp) {
+    profile_request_t *request = &latency_requests[id];
+    if (pending && !request->active) {
+        request->active = true;
+        request->start = timestamp;
+        request->served = timestamp;
+    } else if (!pending && request->active) {
+        request->active = false;
+        profile_stats_add(&latency_stats[id], request->served - request->start);
+    }
+}
+
+void profile_latency_served (profile_latency_t id) {
+    if (latency_requests[id].active) {
+        latency_requests[id].served = task_get_cycles();
+    }
+}
+
+uint32_t profile_store (uint32_t address) {
+    uint32_t data[PROFILE_DATA_WORDS];
+    uint32_t *ptr = data;
+    uint64_t elapsed = 0;
+    uint64_t task_run_time[PROFILE_TASK_COUNT];
+
+    for (task_id_t id = 0; id < PROFILE_TASK_COUNT; id++) {
+        task_run_time[id] = (task_get_run_time(id) - task_baseline[id]);
+        elapsed += task_run_time[id];
+    }
+
+    *ptr++ = PROFILE_CLOCK_FREQUENCY;
+    *ptr++ = (uint32_t) (elapsed);
+    *ptr++ = (uint32_t) (elapsed >> 32);
+    *ptr++ = PROFILE_TASK_COUNT;
+    *ptr++ = __PROFILE_PROCESS_COUNT;
+    *ptr++ = __PROFILE_LATENCY_COUNT;
+
+    for (task_id_t id = 0; id < PROFILE_TASK_COUNT; id++) {
+        *ptr++ = (uint32_t) (task_run_time[id]);
+        *ptr++ = (uint32_t) (task_run_time[id] >> 32);
+    }
+
+    for (profile_process_t id = 0; id < __PROFILE_PROCESS_COUNT; id++) {
+        ptr = profile_stats_put(ptr, &process_stats[id]);
+    }
+
+    for (profile_latency_t id = 0; id < __PROFILE_LATENCY_COUNT; id++) {
+        ptr = profile_stats_put(ptr, &latency_stats[id]);
+    }
+
+    for (int i = 0; i < PROFILE_DATA_WORDS; i++) {
+        data[i] = SWAP32(data[i]);
+    }
+
+    fpga_mem_write(address, sizeof(data), (uint8_t *) (data));
+
+    return sizeof(data);
+}
+
+void profile_reset (void) {
+    for (task_id_t id = 0; id < PROFILE_TASK_COUNT; id++) {
+        task_baseline[id] = task_get_run_time(id);
+    }
+
+    for (profile_process_t id = 0; id < __PROFILE_PROCESS_COUNT; id++) {
+        process_stats[id] = (profile_stats_t) { 0 };
+    }
+
+    for (profile_latency_t id = 0; id < __PROFILE_LATENCY_COUNT; id++) {
+        latency_stats[id] = (profile_stats_t) { 0 };
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef PROFILE_H__
+#define PROFILE_H__
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+typedef enum {
+    PROFILE_PROCESS_BUTTON,
+    PROFILE_PROCESS_CFG,
+    PROFILE_PROCESS_DD,
+    PROFILE_PROCESS_ISV,
+    PROFILE_PROCESS_RTC,
+    PROFILE_PROCESS_SD,
+    PROFILE_PROCESS_USB,
+    PROFILE_PROCESS_WRITEBACK,
+    __PROFILE_PROCESS_COUNT
+} profile_process_t;
+
+typedef enum {
+    PROFILE_LATENCY_CFG,
+    PROFILE_LATENCY_DD,
+    __PROFILE_LATENCY_COUNT
+} profile_latency_t;
+
+
+void profile_process_run (profile_process_t id, void (*process)(void));
+void profile_latency_track (profile_latency_t id, bool pending, uint32_t timestamp);
+void profile_latency_served (profile_latency_t id);
+uint32_t profile_store (uint32_t address);
+void profile_reset (void);
+
+
+#endif
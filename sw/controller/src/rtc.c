@@ -26,7 +26,7 @@
 #define RTC_RTCWKDAY_VBATEN         (1 << 3)
 #define RTC_RTCWKDAY_OSCRUN         (1 << 5)
 
-#define RTC_SETTINGS_VERSION        (1)
+#define RTC_SETTINGS_VERSION        (2)
 
 
 static rtc_time_t rtc_time = {
@@ -40,6 +40,7 @@ static rtc_time_t rtc_time = {
 };
 static bool rtc_time_valid = false;
 static volatile bool rtc_time_pending = false;
+static volatile bool rtc_time_changed = true;
 
 static uint8_t rtc_region = 0xFF;
 static volatile bool rtc_region_pending = false;
@@ -114,6 +115,10 @@ static void rtc_read_time (void) {
     rtc_sanitize_time(regs);
 
     if (!rtc_time_pending) {
+        if (rtc_time.second != regs[0]) {
+            rtc_time_changed = true;
+        }
+
         rtc_time.second = regs[0];
         rtc_time.minute = regs[1];
         rtc_time.hour = regs[2];
@@ -235,6 +240,7 @@ void rtc_set_time (rtc_time_t *time) {
     rtc_time.month = time->month;
     rtc_time.year = time->year;
     rtc_time_pending = true;
+    rtc_time_changed = true;
 
     hw_tim_enable_irq(TIM_ID_RTC);
     hw_i2c_enable_irq();
@@ -262,6 +268,10 @@ void rtc_set_settings (rtc_settings_t *settings) {
     hw_tim_enable_irq(TIM_ID_LED);
 }
 
+bool rtc_is_busy (void) {
+    return rtc_time_changed;
+}
+
 void rtc_task (void) {
     rtc_init();
 
@@ -316,6 +326,12 @@ void rtc_process (void) {
         fpga_reg_set(REG_RTC_SCR, RTC_SCR_DONE);
     }
 
+    if (!rtc_time_changed) {
+        return;
+    }
+
+    rtc_time_changed = false;
+
     rtc_get_time(&time);
 
     data[0] = (
@@ -16,8 +16,12 @@ typedef struct {
     volatile uint8_t year;
 } rtc_time_t;
 
+#define RTC_SETTINGS_MENU_CACHE_WORDS   (12)
+
+
 typedef struct {
     volatile bool led_enabled;
+    volatile uint32_t menu_cache[RTC_SETTINGS_MENU_CACHE_WORDS];
 } rtc_settings_t;
 
 
@@ -27,6 +31,7 @@ uint8_t rtc_get_region (void);
 void rtc_set_region (uint8_t region);
 rtc_settings_t *rtc_get_settings (void);
 void rtc_set_settings (rtc_settings_t *settings);
+bool rtc_is_busy (void);
 void rtc_task (void);
 void rtc_process (void);
 
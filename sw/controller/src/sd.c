@@ -19,6 +19,8 @@
 #define ACMD41_ARG_OCR                  (0x300000 << 0)
 #define ACMD41_ARG_HCS                  (1 << 30)
 
+#define CMD23_MAX_BLOCK_COUNT           (0xFFFF)
+
 #define R3_OCR                          (0x300000 << 0)
 #define R3_CCS                          (1 << 30)
 #define R3_BUSY                         (1 << 31)
@@ -32,7 +34,11 @@
 #define SWITCH_FUNCTION_GROUP_1         (SD_INIT_BUFFER_ADDRESS + 12)
 #define SWITCH_FUNCTION_GROUP_1_HS      (1 << 1)
 
+#define SCR_CMD_SUPPORT                 (SD_INIT_BUFFER_ADDRESS + 0)
+#define SCR_CMD_SUPPORT_CMD23           (1 << 1)
+
 #define DAT_BLOCK_MAX_COUNT             (256)
+#define DAT_QUEUE_SIZE                  (16)
 #define DAT_TIMEOUT_INIT_MS             (2000)
 #define DAT_TIMEOUT_DATA_MS             (5000)
 
@@ -56,13 +62,39 @@ typedef enum {
 
 typedef enum {
     DAT_READ,
+    DAT_READ_STREAM,
     DAT_WRITE,
 } dat_mode_t;
 
+typedef enum {
+    QUEUE_STATE_IDLE,
+    QUEUE_STATE_DATA,
+    QUEUE_STATE_WRITE_BUSY,
+} queue_state_t;
+
+typedef struct {
+    uint32_t address;
+    uint32_t sector;
+    uint32_t count;
+    bool write;
+    bool error;
+    sd_callback_t *callback;
+} sd_request_t;
+
 
 struct process {
     bool card_initialized;
     bool card_type_block;
+    bool cmd23_supported;
+    bool read_stream_open;
+    uint32_t read_stream_sector;
+    sd_request_t queue[DAT_QUEUE_SIZE];
+    uint8_t queue_head;
+    uint8_t queue_count;
+    queue_state_t queue_state;
+    bool queue_error;
+    uint32_t dat_blocks;
+    uint32_t write_blocks;
     uint32_t rca;
     uint8_t csd[16];
     uint8_t cid[16];
@@ -175,17 +207,19 @@ static void sd_dat_prepare (uint32_t address, uint32_t count, dat_mode_t mode) {
     uint32_t sd_dat = (((count - 1) << SD_DAT_BLOCKS_BIT) | SD_DAT_FIFO_FLUSH);
     uint32_t sd_dma_scr = DMA_SCR_START;
 
-    if (mode == DAT_READ) {
+    if (mode == DAT_READ_STREAM) {
+        sd_dat |= (SD_DAT_START_READ | SD_DAT_STREAM);
+        sd_dma_scr |= DMA_SCR_DIRECTION;
+    } else if (mode == DAT_READ) {
         sd_dat |= SD_DAT_START_READ;
         sd_dma_scr |= DMA_SCR_DIRECTION;
     } else {
         sd_dat |= SD_DAT_START_WRITE;
     }
 
-    fpga_reg_set(REG_SD_DAT, sd_dat);
-    fpga_reg_set(REG_SD_DMA_ADDRESS, address);
-    fpga_reg_set(REG_SD_DMA_LENGTH, length);
-    fpga_reg_set(REG_SD_DMA_SCR, sd_dma_scr);
+    uint32_t dat_regs[4] = { sd_dat, address, length, sd_dma_scr };
+
+    fpga_reg_set_multiple(REG_SD_DAT, dat_regs, 4);
 }
 
 static void sd_dat_abort (void) {
@@ -197,8 +231,10 @@ static bool sd_dat_wait (uint16_t timeout) {
     sd_prepare_timeout(timeout);
 
     do {
-        uint32_t sd_dat = fpga_reg_get(REG_SD_DAT);
-        uint32_t sd_dma_scr = fpga_reg_get(REG_SD_DMA_SCR);
+        uint32_t dat_regs[4];
+        fpga_reg_get_multiple(REG_SD_DAT, dat_regs, 4);
+        uint32_t sd_dat = dat_regs[0];
+        uint32_t sd_dma_scr = dat_regs[3];
         led_blink_act();
         if ((!(sd_dat & SD_DAT_BUSY)) && (!(sd_dma_scr & DMA_SCR_BUSY))) {
             sd_clear_timeout();
@@ -211,17 +247,193 @@ static bool sd_dat_wait (uint16_t timeout) {
     return true;
 }
 
+static uint32_t sd_card_address (uint32_t sector) {
+    return (p.card_type_block ? sector : (sector * SD_SECTOR_SIZE));
+}
+
+static void sd_read_stream_close (void) {
+    if (p.read_stream_open) {
+        p.read_stream_open = false;
+        sd_dat_abort();
+        sd_cmd(12, 0, RSP_R1b, NULL);
+    }
+}
+
+static bool sd_request_start (sd_request_t *request) {
+    p.dat_blocks = ((request->count > DAT_BLOCK_MAX_COUNT) ? DAT_BLOCK_MAX_COUNT : request->count);
+
+    if (request->write) {
+        if (p.write_blocks == 0) {
+            sd_read_stream_close();
+            p.write_blocks = ((request->count > CMD23_MAX_BLOCK_COUNT) ? CMD23_MAX_BLOCK_COUNT : request->count);
+            if (p.cmd23_supported) {
+                if (sd_cmd(23, p.write_blocks, RSP_R1, NULL)) {
+                    p.write_blocks = 0;
+                    return true;
+                }
+            }
+            if (sd_cmd(25, sd_card_address(request->sector), RSP_R1, NULL)) {
+                p.write_blocks = 0;
+                return true;
+            }
+        }
+        if (p.dat_blocks > p.write_blocks) {
+            p.dat_blocks = p.write_blocks;
+        }
+        sd_dat_prepare(request->address, p.dat_blocks, DAT_WRITE);
+    } else {
+        if (p.read_stream_open && (p.read_stream_sector != request->sector)) {
+            sd_read_stream_close();
+        }
+        sd_dat_prepare(request->address, p.dat_blocks, DAT_READ_STREAM);
+        if (!p.read_stream_open) {
+            if (sd_cmd(18, sd_card_address(request->sector), RSP_R1, NULL)) {
+                sd_dat_abort();
+                return true;
+            }
+            p.read_stream_open = true;
+        }
+    }
+
+    led_blink_act();
+    sd_prepare_timeout(DAT_TIMEOUT_DATA_MS);
+
+    return false;
+}
+
+static void sd_request_abort (sd_request_t *request) {
+    sd_clear_timeout();
+    sd_dat_abort();
+    if (request->write) {
+        if (p.write_blocks > 0) {
+            p.write_blocks = 0;
+            sd_cmd(12, 0, RSP_R1b, NULL);
+        }
+    } else {
+        sd_read_stream_close();
+    }
+}
+
+static void sd_queue_complete (bool error) {
+    sd_callback_t *callback = p.queue[p.queue_head].callback;
+
+    p.queue_error |= error;
+    error = p.queue_error;
+
+    p.queue_head = ((p.queue_head + 1) % DAT_QUEUE_SIZE);
+    p.queue_count -= 1;
+    p.queue_state = QUEUE_STATE_IDLE;
+
+    if (callback != NULL) {
+        p.queue_error = false;
+        callback(error);
+    }
+}
+
+static void sd_queue_process (void) {
+    while (p.queue_count > 0) {
+        sd_request_t *request = &p.queue[p.queue_head];
+
+        switch (p.queue_state) {
+            case QUEUE_STATE_IDLE:
+                if (request->count == 0) {
+                    sd_queue_complete(request->error);
+                    break;
+                }
+                if (!p.card_initialized) {
+                    sd_queue_complete(true);
+                    break;
+                }
+                if (sd_request_start(request)) {
+                    sd_request_abort(request);
+                    sd_queue_complete(true);
+                    break;
+                }
+                p.queue_state = QUEUE_STATE_DATA;
+                return;
+
+            case QUEUE_STATE_DATA: {
+                uint32_t dat_regs[4];
+                fpga_reg_get_multiple(REG_SD_DAT, dat_regs, 4);
+                uint32_t sd_dat = dat_regs[0];
+                uint32_t sd_dma_scr = dat_regs[3];
+                bool busy = ((sd_dat & SD_DAT_BUSY) || (sd_dma_scr & DMA_SCR_BUSY));
+                led_blink_act();
+                if (busy && !sd_did_timeout()) {
+                    return;
+                }
+                if (busy || (sd_dat & SD_DAT_ERROR)) {
+                    sd_request_abort(request);
+                    sd_queue_complete(true);
+                    break;
+                }
+                sd_clear_timeout();
+                request->address += (p.dat_blocks * SD_SECTOR_SIZE);
+                request->sector += p.dat_blocks;
+                request->count -= p.dat_blocks;
+                p.queue_state = QUEUE_STATE_IDLE;
+                if (request->write) {
+                    p.write_blocks -= p.dat_blocks;
+                    if (p.write_blocks == 0) {
+                        if (p.cmd23_supported) {
+                            p.queue_state = QUEUE_STATE_WRITE_BUSY;
+                            break;
+                        }
+                        sd_cmd(12, 0, RSP_R1b, NULL);
+                    }
+                } else {
+                    p.read_stream_sector = request->sector;
+                }
+                if (request->count == 0) {
+                    sd_queue_complete(false);
+                }
+                break;
+            }
+
+            case QUEUE_STATE_WRITE_BUSY:
+                if (fpga_reg_get(REG_SD_SCR) & SD_SCR_CARD_BUSY) {
+                    return;
+                }
+                p.queue_state = QUEUE_STATE_IDLE;
+                if (request->count == 0) {
+                    sd_queue_complete(false);
+                }
+                break;
+        }
+    }
+}
+
+static void sd_enqueue_request (uint32_t address, uint32_t sector, uint32_t count, bool write, bool error, sd_callback_t *callback) {
+    while (p.queue_count >= DAT_QUEUE_SIZE) {
+        sd_queue_process();
+    }
+
+    sd_request_t *request = &p.queue[(p.queue_head + p.queue_count) % DAT_QUEUE_SIZE];
+
+    request->address = address;
+    request->sector = sector;
+    request->count = count;
+    request->write = write;
+    request->error = error;
+    request->callback = callback;
+
+    p.queue_count += 1;
+}
+
 
 bool sd_card_init (void) {
     uint32_t arg;
     uint32_t rsp;
     uint16_t tmp;
+    uint32_t scr;
 
     if (p.card_initialized) {
         return false;
     }
 
     p.card_initialized = true;
+    p.cmd23_supported = false;
+    p.read_stream_open = false;
     p.rca = 0;
 
     led_blink_act();
@@ -295,6 +507,19 @@ bool sd_card_init (void) {
         return true;
     }
 
+    sd_dat_prepare(SD_INIT_BUFFER_ADDRESS, 1, DAT_READ);
+    if (sd_acmd(51, 0, RSP_R1, NULL)) {
+        sd_dat_abort();
+    } else {
+        sd_dat_wait(DAT_TIMEOUT_INIT_MS);
+        if (sd_did_timeout()) {
+            sd_card_deinit();
+            return true;
+        }
+        fpga_mem_read(SCR_CMD_SUPPORT, 4, (uint8_t *) (&scr));
+        p.cmd23_supported = (SWAP32(scr) & SCR_CMD_SUPPORT_CMD23);
+    }
+
     sd_dat_prepare(SD_INIT_BUFFER_ADDRESS, 1, DAT_READ);
     if (sd_cmd(6, CMD6_ARG_CHECK_HS, RSP_R1, NULL)) {
         sd_dat_abort();
@@ -335,6 +560,16 @@ bool sd_card_init (void) {
 
 void sd_card_deinit (void) {
     if (p.card_initialized) {
+        if (sd_card_is_inserted()) {
+            while (p.queue_count > 0) {
+                sd_queue_process();
+            }
+        } else if (p.queue_state != QUEUE_STATE_IDLE) {
+            sd_request_abort(&p.queue[p.queue_head]);
+            sd_queue_complete(true);
+        }
+        sd_read_stream_close();
+        p.write_blocks = 0;
         p.card_initialized = false;
         sd_set_clock(CLOCK_400KHZ);
         sd_cmd(0, 0, RSP_NONE, NULL);
@@ -371,98 +606,57 @@ bool sd_card_get_info (uint32_t address) {
     return false;
 }
 
-bool sd_write_sectors (uint32_t address, uint32_t sector, uint32_t count) {
-    if (!p.card_initialized || (count == 0)) {
-        return true;
-    }
-
-    if (!p.card_type_block) {
-        sector *= SD_SECTOR_SIZE;
-    }
-
-    while (count > 0) {
-        uint32_t blocks = ((count > DAT_BLOCK_MAX_COUNT) ? DAT_BLOCK_MAX_COUNT : count);
-        led_blink_act();
-        if (sd_cmd(25, sector, RSP_R1, NULL)) {
-            return true;
-        }
-        sd_dat_prepare(address, blocks, DAT_WRITE);
-        if (sd_dat_wait(DAT_TIMEOUT_DATA_MS)) {
-            sd_dat_abort();
-            sd_cmd(12, 0, RSP_R1b, NULL);
-            return true;
-        }
-        sd_cmd(12, 0, RSP_R1b, NULL);
-        address += (blocks * SD_SECTOR_SIZE);
-        sector += (blocks * (p.card_type_block ? 1 : SD_SECTOR_SIZE));
-        count -= blocks;
-    }
-
-    return false;
+void sd_enqueue (uint32_t address, uint32_t sector, uint32_t count, bool write, sd_callback_t *callback) {
+    sd_enqueue_request(address, sector, count, write, (count == 0), callback);
 }
 
-bool sd_read_sectors (uint32_t address, uint32_t sector, uint32_t count) {
-    if (!p.card_initialized || (count == 0)) {
-        return true;
-    }
+void sd_enqueue_sector_table (uint32_t address, uint32_t *sector_table, uint32_t count, bool write, sd_callback_t *callback) {
+    uint32_t starting_sector = 0;
+    uint32_t sectors_to_process = 0;
+    bool error = (count == 0);
 
-    if (!p.card_type_block) {
-        sector *= SD_SECTOR_SIZE;
+    for (uint32_t i = 0; i < count; i++) {
+        if (sector_table[i] == 0) {
+            error = true;
+        }
     }
 
-    while (count > 0) {
-        uint32_t blocks = ((count > DAT_BLOCK_MAX_COUNT) ? DAT_BLOCK_MAX_COUNT : count);
-        led_blink_act();
-        sd_dat_prepare(address, blocks, DAT_READ);
-        if (sd_cmd(18, sector, RSP_R1, NULL)) {
-            sd_dat_abort();
-            return true;
-        }
-        if (sd_dat_wait(DAT_TIMEOUT_DATA_MS)) {
-            if (sd_did_timeout()) {
-                sd_cmd(12, 0, RSP_R1b, NULL);
+    if (!error) {
+        for (uint32_t i = 0; i < count; i++) {
+            sectors_to_process += 1;
+            if ((i < (count - 1)) && ((sector_table[i] + 1) == sector_table[i + 1])) {
+                continue;
             }
-            return true;
+            sd_enqueue_request(address, sector_table[starting_sector], sectors_to_process, write, false, NULL);
+            address += (sectors_to_process * SD_SECTOR_SIZE);
+            starting_sector += sectors_to_process;
+            sectors_to_process = 0;
         }
-        sd_cmd(12, 0, RSP_R1b, NULL);
-        address += (blocks * SD_SECTOR_SIZE);
-        sector += (blocks * (p.card_type_block ? 1 : SD_SECTOR_SIZE));
-        count -= blocks;
     }
 
-    return false;
+    sd_enqueue_request(0, 0, 0, write, error, callback);
 }
 
-bool sd_optimize_sectors (uint32_t address, uint32_t *sector_table, uint32_t count, sd_process_sectors_t sd_process_sectors) {
-    uint32_t starting_sector = 0;
-    uint32_t sectors_to_process = 0;
-
-    if (count == 0) {
-        return true;
-    }
+void sd_enqueue_complete (bool error, sd_callback_t *callback) {
+    sd_enqueue_request(0, 0, 0, false, error, callback);
+}
 
-    for (uint32_t i = 0; i < count; i++) {
-        if (sector_table[i] == 0) {
-            return true;
-        }
-        sectors_to_process += 1;
-        if ((i < (count - 1)) && ((sector_table[i] + 1) == sector_table[i + 1])) {
-            continue;
-        }
-        bool error = sd_process_sectors(address, sector_table[starting_sector], sectors_to_process);
-        if (error) {
-            return true;
-        }
-        address += (sectors_to_process * SD_SECTOR_SIZE);
-        starting_sector += sectors_to_process;
-        sectors_to_process = 0;
-    }
+uint32_t sd_get_queue_free (void) {
+    return (DAT_QUEUE_SIZE - p.queue_count);
+}
 
-    return false;
+bool sd_is_busy (void) {
+    return (p.queue_count > 0);
 }
 
 void sd_init (void) {
     p.card_initialized = false;
+    p.read_stream_open = false;
+    p.queue_head = 0;
+    p.queue_count = 0;
+    p.queue_state = QUEUE_STATE_IDLE;
+    p.queue_error = false;
+    p.write_blocks = 0;
     sd_set_clock(CLOCK_STOP);
 }
 
@@ -470,4 +664,5 @@ void sd_process (void) {
     if (!sd_card_is_inserted()) {
         sd_card_deinit();
     }
+    sd_queue_process();
 }
@@ -9,7 +9,7 @@
 #define SD_CARD_INFO_SIZE   (32)
 
 
-typedef bool sd_process_sectors_t (uint32_t address, uint32_t sector, uint32_t count);
+typedef void sd_callback_t (bool error);
 
 
 bool sd_card_init (void);
@@ -17,9 +17,11 @@ void sd_card_deinit (void);
 bool sd_card_is_inserted (void);
 uint32_t sd_card_get_status (void);
 bool sd_card_get_info (uint32_t address);
-bool sd_write_sectors (uint32_t address, uint32_t sector, uint32_t count);
-bool sd_read_sectors (uint32_t address, uint32_t sector, uint32_t count);
-bool sd_optimize_sectors (uint32_t address, uint32_t *sector_table, uint32_t count, sd_process_sectors_t sd_process_sectors);
+void sd_enqueue (uint32_t address, uint32_t sector, uint32_t count, bool write, sd_callback_t *callback);
+void sd_enqueue_sector_table (uint32_t address, uint32_t *sector_table, uint32_t count, bool write, sd_callback_t *callback);
+void sd_enqueue_complete (bool error, sd_callback_t *callback);
+uint32_t sd_get_queue_free (void);
+bool sd_is_busy (void);
 void sd_init (void);
 void sd_process (void);
 
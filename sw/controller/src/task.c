@@ -6,12 +6,14 @@
 #define TASK_INITIAL_XPSR       (0x21000000UL)
 #define TASK_CONTEXT_SWITCH()   { SCB->ICSR = (1 << SCB_ICSR_PENDSVSET_Pos); }
 #define TASK_STACK_FILL_VALUE   (0xDEADBEEF)
+#define TASK_IDLE_STACK_SIZE    (256)
 
 
 typedef enum {
     TASK_FLAG_NONE  = 0,
     TASK_FLAG_READY = (1 << 0),
     TASK_FLAG_RESET = (1 << 1),
+    TASK_FLAG_SLEEPING = (1 << 2),
 } task_flags_t;
 
 
@@ -20,13 +22,25 @@ typedef struct {
     uint32_t initial_sp;
     uint32_t sp;
     task_flags_t flags;
+    task_priority_t priority;
+    uint32_t wakeup_tick;
+    uint64_t run_time;
 } task_t;
 
 
 static task_t task_table[__TASK_ID_MAX];
 static volatile task_id_t task_current = 0;
+static volatile uint32_t task_ticks = 0;
+static uint32_t task_switch_timestamp = 0;
+static uint8_t task_idle_stack[TASK_IDLE_STACK_SIZE] __attribute__((aligned(8)));
 
 
+static void task_idle (void) {
+    while (1) {
+        __WFI();
+    }
+}
+
 static void task_exit (void) {
     task_table[task_current].flags = TASK_FLAG_NONE;
     task_yield();
@@ -50,16 +64,59 @@ static void task_reset (task_id_t id) {
     task_initialize(id);
 }
 
+static void task_sleep_until (uint32_t tick) {
+    task_t *task = &task_table[task_current];
+    task->wakeup_tick = tick;
+    task->flags = ((task->flags & ~(TASK_FLAG_READY)) | TASK_FLAG_SLEEPING);
+    TASK_CONTEXT_SWITCH();
+}
+
+static void task_scheduler_init (void) {
+    task_create(TASK_ID_IDLE, task_idle, task_idle_stack, TASK_IDLE_STACK_SIZE, TASK_PRIORITY_IDLE);
+
+    NVIC_SetPriority(SysTick_IRQn, 2);
+    NVIC_SetPriority(PendSV_IRQn, 3);
+
+    SysTick->CTRL |= SysTick_CTRL_TICKINT_Msk;
+
+    task_switch_timestamp = task_get_cycles();
+}
+
+static __attribute__((naked, noreturn)) void task_scheduler_jump (uint32_t sp) {
+    asm volatile (
+        "add r0, #32 \n"
+        "msr psp, r0 \n"
+        "movs r0, #2 \n"
+        "msr CONTROL, r0 \n"
+        "isb \n"
+        "pop {r0-r5} \n"
+        "mov lr, r5 \n"
+        "pop {r3} \n"
+        "pop {r2} \n"
+        "cpsie i \n"
+        "bx r3 \n"
+    );
+}
+
 static uint32_t task_switch_context (uint32_t sp) {
+    uint32_t now = task_get_cycles();
+    uint32_t elapsed = (now - task_switch_timestamp);
+
+    task_table[task_current].run_time += elapsed;
+    task_switch_timestamp = now;
+
     task_table[task_current].sp = sp;
 
+    task_id_t next = TASK_ID_IDLE;
+
     for (task_id_t id = 0; id < __TASK_ID_MAX; id++) {
-        if (task_table[id].flags & TASK_FLAG_READY) {
-            task_current = id;
-            break;
+        if ((task_table[id].flags & TASK_FLAG_READY) && (task_table[id].priority > task_table[next].priority)) {
+            next = id;
         }
     }
 
+    task_current = next;
+
     if (task_table[task_current].flags & TASK_FLAG_RESET) {
         task_reset(task_current);
     }
@@ -68,7 +125,7 @@ static uint32_t task_switch_context (uint32_t sp) {
 }
 
 
-void task_create (task_id_t id, void (*code)(void), void *stack, size_t stack_size) {
+void task_create (task_id_t id, void (*code)(void), void *stack, size_t stack_size, task_priority_t priority) {
     if (id < __TASK_ID_MAX) {
         for (size_t i = 0; i < stack_size; i += sizeof(uint32_t)) {
             (*(uint32_t *) (stack + i)) = TASK_STACK_FILL_VALUE;
@@ -77,6 +134,8 @@ void task_create (task_id_t id, void (*code)(void), void *stack, size_t stack_si
         task->initial_pc = (uint32_t) (code);
         task->initial_sp = (((uint32_t) (stack)) + stack_size);
         task->flags = TASK_FLAG_READY;
+        task->priority = priority;
+        task->run_time = 0;
         task_initialize(id);
     }
 }
@@ -86,13 +145,37 @@ void task_yield (void) {
     TASK_CONTEXT_SWITCH();
 }
 
+void task_sleep_ms (uint32_t ms) {
+    __disable_irq();
+    task_sleep_until(task_ticks + ms);
+    __enable_irq();
+}
+
+bool task_wait (volatile bool *condition, uint32_t timeout_ms) {
+    uint32_t deadline = task_ticks + timeout_ms;
+
+    while (1) {
+        __disable_irq();
+        if (*condition) {
+            __enable_irq();
+            return false;
+        }
+        if (((int32_t) (task_ticks - deadline)) >= 0) {
+            __enable_irq();
+            return true;
+        }
+        task_sleep_until(deadline);
+        __enable_irq();
+    }
+}
+
 void task_set_ready (task_id_t id) {
-    task_table[id].flags |= TASK_FLAG_READY;
+    task_table[id].flags = ((task_table[id].flags & ~(TASK_FLAG_SLEEPING)) | TASK_FLAG_READY);
     TASK_CONTEXT_SWITCH();
 }
 
 void task_set_ready_and_reset (task_id_t id) {
-    task_table[id].flags |= (TASK_FLAG_RESET | TASK_FLAG_READY);
+    task_table[id].flags = ((task_table[id].flags & ~(TASK_FLAG_SLEEPING)) | TASK_FLAG_RESET | TASK_FLAG_READY);
     TASK_CONTEXT_SWITCH();
 }
 
@@ -105,30 +188,57 @@ size_t task_get_stack_usage (void *stack, size_t stack_size) {
     return 0;
 }
 
-__attribute__((naked)) void task_scheduler_start (void) {
-    uint32_t sp = task_table[task_current].sp;
+uint32_t task_get_ticks (void) {
+    return task_ticks;
+}
 
-    NVIC_SetPriority(PendSV_IRQn, 3);
+uint32_t task_get_cycles (void) {
+    uint32_t ticks;
+    uint32_t value;
+    bool wrapped;
+    do {
+        ticks = task_ticks;
+        value = SysTick->VAL;
+        wrapped = (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk);
+        if (wrapped) {
+            value = SysTick->VAL;
+        }
+    } while (ticks != task_ticks);
+    if (wrapped) {
+        ticks += 1;
+    }
+    return ((ticks * (SysTick->LOAD + 1)) + (SysTick->LOAD - value));
+}
 
-    asm volatile (
-        "add %[sp], #32 \n"
-        "msr psp, %[sp] \n"
-        "movs r0, #2 \n"
-        "msr CONTROL, r0 \n"
-        "isb \n"
-        "pop {r0-r5} \n"
-        "mov lr, r5 \n"
-        "pop {r3} \n"
-        "pop {r2} \n"
-        "cpsie i \n"
-        "bx r3 \n"
-        :: [sp] "r" (sp)
-    );
+uint64_t task_get_run_time (task_id_t id) {
+    uint64_t run_time;
+    __disable_irq();
+    run_time = task_table[id].run_time;
+    if (id == task_current) {
+        run_time += (task_get_cycles() - task_switch_timestamp);
+    }
+    __enable_irq();
+    return run_time;
+}
 
-    while (1);
+void task_scheduler_start (void) {
+    task_scheduler_init();
+    task_scheduler_jump(task_table[task_current].sp);
 }
 
 
+void SysTick_Handler (void) {
+    task_ticks += 1;
+
+    for (task_id_t id = 0; id < __TASK_ID_MAX; id++) {
+        task_t *task = &task_table[id];
+        if ((task->flags & TASK_FLAG_SLEEPING) && (((int32_t) (task_ticks - task->wakeup_tick)) >= 0)) {
+            task->flags = ((task->flags & ~(TASK_FLAG_SLEEPING)) | TASK_FLAG_READY);
+            TASK_CONTEXT_SWITCH();
+        }
+    }
+}
+
 __attribute__((naked)) void PendSV_Handler (void) {
     asm volatile (
         "mrs r1, psp \n"
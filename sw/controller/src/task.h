@@ -2,7 +2,9 @@
 #define TASK_H__
 
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 
 typedef enum {
@@ -10,15 +12,28 @@ typedef enum {
     TASK_ID_RTC,
     TASK_ID_LED,
     TASK_ID_GVR,
+    TASK_ID_IDLE,
     __TASK_ID_MAX
 } task_id_t;
 
+typedef enum {
+    TASK_PRIORITY_IDLE,
+    TASK_PRIORITY_LOW,
+    TASK_PRIORITY_NORMAL,
+    TASK_PRIORITY_HIGH,
+} task_priority_t;
+
 
-void task_create (task_id_t id, void (*code)(void), void *stack, size_t stack_size);
+void task_create (task_id_t id, void (*code)(void), void *stack, size_t stack_size, task_priority_t priority);
 void task_yield (void);
+void task_sleep_ms (uint32_t ms);
+bool task_wait (volatile bool *condition, uint32_t timeout_ms);
 void task_set_ready (task_id_t id);
 void task_set_ready_and_reset (task_id_t id);
 size_t task_get_stack_usage (void *stack, size_t stack_size);
+uint32_t task_get_ticks (void);
+uint32_t task_get_cycles (void);
+uint64_t task_get_run_time (task_id_t id);
 void task_scheduler_start (void);
 
 
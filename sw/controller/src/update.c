@@ -45,18 +45,7 @@ static uint32_t update_align (uint32_t value) {
 }
 
 static uint32_t update_checksum (uint32_t address, uint32_t length) {
-    uint8_t buffer[128];
-    uint32_t block_size;
-    uint32_t checksum = 0;
-    hw_crc32_reset();
-    while (length > 0) {
-        block_size = (length > sizeof(buffer)) ? sizeof(buffer) : length;
-        fpga_mem_read(address, block_size, buffer);
-        checksum = hw_crc32_calculate(buffer, block_size);
-        address += block_size;
-        length -= block_size;
-    }
-    return checksum;
+    return fpga_mem_crc32(address, length);
 }
 
 static uint32_t update_write_token (uint32_t *address) {
@@ -130,10 +119,18 @@ static void update_blink_led (uint32_t on, uint32_t off, int repeat) {
 }
 
 static void update_status_notify (update_status_t status) {
+    uint8_t *data = status_data;
+    size_t length = sizeof(status_data);
     status_data[sizeof(status_data) - 1] = (uint8_t) (status);
-    for (int i = 0; i < sizeof(status_data); i++) {
-        while (!(fpga_usb_status_get() & USB_STATUS_TXE));
-        fpga_usb_push(status_data[i]);
+    while (length > 0) {
+        size_t written = fpga_usb_write_burst(data, length);
+        if ((written == 0) && (fpga_usb_status_get() & USB_STATUS_TXE)) {
+            // FPGA design without burst support, happens when updating from older firmware
+            fpga_usb_push(*data);
+            written = 1;
+        }
+        data += written;
+        length -= written;
     }
     fpga_reg_set(REG_USB_SCR, USB_SCR_WRITE_FLUSH);
     if (status == UPDATE_STATUS_DONE) {
@@ -209,9 +206,7 @@ update_error_t update_backup (uint32_t address, uint32_t *length) {
 
     *length += update_prepare_chunk(&address, CHUNK_ID_BOOTLOADER_DATA);
     bootloader_length = BOOTLOADER_LENGTH;
-    for (uint32_t offset = 0; offset < bootloader_length; offset += FPGA_MAX_MEM_TRANSFER) {
-        fpga_mem_copy(BOOTLOADER_ADDRESS + offset, address + offset, FPGA_MAX_MEM_TRANSFER);
-    }
+    fpga_mem_copy(BOOTLOADER_ADDRESS, address, bootloader_length);
     *length += update_finalize_chunk(&address, bootloader_length);
 
     return UPDATE_OK;
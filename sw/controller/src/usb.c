@@ -4,6 +4,7 @@
 #include "dd.h"
 #include "flash.h"
 #include "fpga.h"
+#include "profile.h"
 #include "rtc.h"
 #include "update.h"
 #include "usb.h"
@@ -12,36 +13,55 @@
 
 enum rx_state {
     RX_STATE_IDLE,
+    RX_STATE_TAG,
     RX_STATE_ARGS,
     RX_STATE_DATA,
 };
 
 enum tx_state {
     TX_STATE_IDLE,
-    TX_STATE_TOKEN,
     TX_STATE_DATA,
     TX_STATE_DMA,
     TX_STATE_FLUSH,
 };
 
 
+#define RESPONSE_QUEUE_SIZE     (4)
+#define TX_BUFFER_SIZE          (12 + 16)
+
+
+typedef struct {
+    bool error;
+    bool tagged;
+    uint32_t tag;
+    usb_tx_info_t info;
+} usb_response_t;
+
+
 struct process {
     enum rx_state rx_state;
     uint8_t rx_counter;
     uint8_t rx_cmd;
+    bool rx_tagged;
+    uint32_t rx_tag;
     uint32_t rx_args[2];
     bool rx_dma_running;
 
     enum tx_state tx_state;
-    uint8_t tx_counter;
     usb_tx_info_t tx_info;
-    uint32_t tx_token;
+    uint8_t tx_buffer[TX_BUFFER_SIZE];
+    uint8_t tx_buffer_length;
+    uint8_t tx_buffer_offset;
     bool tx_dma_running;
 
     bool response_pending;
     bool response_error;
     usb_tx_info_t response_info;
 
+    usb_response_t response_queue[RESPONSE_QUEUE_SIZE];
+    uint8_t response_queue_head;
+    uint8_t response_queue_count;
+
     bool packet_pending;
     usb_tx_info_t packet_info;
 
@@ -55,8 +75,11 @@ static struct process p;
 
 
 static const char CMD_TOKEN[3] = { 'C', 'M', 'D' };
+static const char CMD_TAGGED_ID = 'T';
 static const uint32_t CMP_TOKEN = (0x434D5000UL);
 static const uint32_t ERR_TOKEN = (0x45525200UL);
+static const uint32_t CMP_TAGGED_TOKEN = (0x43505400UL);
+static const uint32_t ERR_TAGGED_TOKEN = (0x45525400UL);
 static const uint32_t PKT_TOKEN = (0x504B5400UL);
 
 
@@ -64,76 +87,99 @@ static bool usb_dma_ready (void) {
     return !((fpga_reg_get(REG_USB_DMA_SCR) & DMA_SCR_BUSY));
 }
 
-static bool usb_rx_byte (uint8_t *data) {
-    if (fpga_usb_status_get() & USB_STATUS_RXNE) {
-        *data = fpga_usb_pop();
-        return true;
-    }
-    return false;
-}
+static uint8_t usb_rx_word_counter = 0;
+static uint8_t usb_rx_word_buffer[4];
 
-static bool usb_tx_byte (uint8_t data) {
-    if (fpga_usb_status_get() & USB_STATUS_TXE) {
-        fpga_usb_push(data);
+static bool usb_rx_word (uint32_t *data) {
+    uint8_t *buffer = usb_rx_word_buffer;
+    usb_rx_word_counter += fpga_usb_read_burst(&buffer[usb_rx_word_counter], 4 - usb_rx_word_counter);
+    if (usb_rx_word_counter == 4) {
+        usb_rx_word_counter = 0;
+        *data = ((buffer[0] << 24) | (buffer[1] << 16) | (buffer[2] << 8) | buffer[3]);
         return true;
     }
     return false;
 }
 
-static uint8_t usb_rx_word_counter = 0;
-static uint32_t usb_rx_word_buffer = 0;
+static uint8_t usb_rx_cmd_counter = 0;
 
-static bool usb_rx_word (uint32_t *data) {
-    uint8_t tmp;
-    while (usb_rx_byte(&tmp)) {
-        usb_rx_word_buffer = (usb_rx_word_buffer << 8) | tmp;
-        usb_rx_word_counter += 1;
-        if (usb_rx_word_counter == 4) {
-            usb_rx_word_counter = 0;
-            *data = usb_rx_word_buffer;
-            usb_rx_word_buffer = 0;
+static bool usb_rx_cmd (uint8_t *cmd, bool *tagged) {
+    uint8_t buffer[4];
+    size_t length = fpga_usb_read_burst(buffer, 4 - usb_rx_cmd_counter);
+    for (size_t i = 0; i < length; i++) {
+        uint8_t data = buffer[i];
+        if (usb_rx_cmd_counter == 3) {
+            *cmd = data;
+            usb_rx_cmd_counter = 0;
             return true;
         }
+        if (usb_rx_cmd_counter == 2) {
+            if ((data != CMD_TOKEN[2]) && (data != CMD_TAGGED_ID)) {
+                usb_rx_cmd_counter = 0;
+                continue;
+            }
+            *tagged = (data == CMD_TAGGED_ID);
+            usb_rx_cmd_counter += 1;
+            continue;
+        }
+        if (data != CMD_TOKEN[usb_rx_cmd_counter++]) {
+            usb_rx_cmd_counter = 0;
+        }
     }
     return false;
 }
 
-static uint8_t usb_tx_word_counter = 0;
+static void usb_tx_buffer_put (uint32_t data) {
+    p.tx_buffer[p.tx_buffer_length++] = (data >> 24);
+    p.tx_buffer[p.tx_buffer_length++] = (data >> 16);
+    p.tx_buffer[p.tx_buffer_length++] = (data >> 8);
+    p.tx_buffer[p.tx_buffer_length++] = data;
+}
 
-static bool usb_tx_word (uint32_t data) {
-    while (usb_tx_byte(data >> ((3 - usb_tx_word_counter) * 8))) {
-        usb_tx_word_counter += 1;
-        if (usb_tx_word_counter == 4) {
-            usb_tx_word_counter = 0;
+static bool usb_response_is_barrier (usb_tx_info_t *info) {
+    return (info->dma_length > 0) || (info->done_callback != NULL);
+}
+
+static bool usb_response_queue_blocked (void) {
+    if (p.response_queue_count >= RESPONSE_QUEUE_SIZE) {
+        return true;
+    }
+    if ((p.tx_state != TX_STATE_IDLE) && usb_response_is_barrier(&p.tx_info)) {
+        return true;
+    }
+    for (int i = 0; i < p.response_queue_count; i++) {
+        uint8_t index = (p.response_queue_head + i) % RESPONSE_QUEUE_SIZE;
+        if (usb_response_is_barrier(&p.response_queue[index].info)) {
             return true;
         }
     }
     return false;
 }
 
-static uint8_t usb_rx_cmd_counter = 0;
+static void usb_response_queue_push (void) {
+    uint8_t index = (p.response_queue_head + p.response_queue_count) % RESPONSE_QUEUE_SIZE;
+    usb_response_t *response = &p.response_queue[index];
+    response->error = p.response_error;
+    response->tagged = p.rx_tagged;
+    response->tag = p.rx_tag;
+    response->info = p.response_info;
+    p.response_queue_count += 1;
+    p.response_pending = false;
+}
 
-static bool usb_rx_cmd (uint8_t *cmd) {
-    uint8_t data;
-    while (usb_rx_byte(&data)) {
-        if (usb_rx_cmd_counter == 3) {
-            *cmd = data;
-            usb_rx_cmd_counter = 0;
-            return true;
-        }
-        if (data != CMD_TOKEN[usb_rx_cmd_counter++]) {
-            usb_rx_cmd_counter = 0;
-            return false;
-        }
-    }
-    return false;
+static usb_response_t *usb_response_queue_pop (void) {
+    usb_response_t *response = &p.response_queue[p.response_queue_head];
+    p.response_queue_head = (p.response_queue_head + 1) % RESPONSE_QUEUE_SIZE;
+    p.response_queue_count -= 1;
+    return response;
 }
 
 static void usb_rx_process (void) {
     if (p.rx_state == RX_STATE_IDLE) {
-        if (!p.response_pending && usb_rx_cmd(&p.rx_cmd)) {
-            p.rx_state = RX_STATE_ARGS;
+        if (!usb_response_queue_blocked() && usb_rx_cmd(&p.rx_cmd, &p.rx_tagged)) {
+            p.rx_state = p.rx_tagged ? RX_STATE_TAG : RX_STATE_ARGS;
             p.rx_counter = 0;
+            p.rx_tag = 0;
             p.rx_dma_running = false;
             p.response_error = false;
             p.response_info.cmd = p.rx_cmd;
@@ -143,6 +189,12 @@ static void usb_rx_process (void) {
         }
     }
 
+    if (p.rx_state == RX_STATE_TAG) {
+        if (usb_rx_word(&p.rx_tag)) {
+            p.rx_state = RX_STATE_ARGS;
+        }
+    }
+
     if (p.rx_state == RX_STATE_ARGS) {
         while (usb_rx_word(&p.rx_args[p.rx_counter])) {
             p.rx_counter += 1;
@@ -236,9 +288,8 @@ static void usb_rx_process (void) {
             case 'M':
                 if (usb_dma_ready()) {
                     if (!p.rx_dma_running) {
-                        fpga_reg_set(REG_USB_DMA_ADDRESS, p.rx_args[0]);
-                        fpga_reg_set(REG_USB_DMA_LENGTH, p.rx_args[1]);
-                        fpga_reg_set(REG_USB_DMA_SCR, DMA_SCR_DIRECTION | DMA_SCR_START);
+                        uint32_t dma_regs[3] = { p.rx_args[0], p.rx_args[1], DMA_SCR_DIRECTION | DMA_SCR_START };
+                        fpga_reg_set_multiple(REG_USB_DMA_ADDRESS, dma_regs, 3);
                         p.rx_dma_running = true;
                     } else {
                         p.rx_state = RX_STATE_IDLE;
@@ -251,9 +302,8 @@ static void usb_rx_process (void) {
                 if ((p.read_length > 0) && usb_dma_ready()) {
                     uint32_t length = (p.read_length > p.rx_args[1]) ? p.rx_args[1] : p.read_length;
                     if (!p.rx_dma_running) {
-                        fpga_reg_set(REG_USB_DMA_ADDRESS, p.read_address);
-                        fpga_reg_set(REG_USB_DMA_LENGTH, length);
-                        fpga_reg_set(REG_USB_DMA_SCR, DMA_SCR_DIRECTION | DMA_SCR_START);
+                        uint32_t dma_regs[3] = { p.read_address, length, DMA_SCR_DIRECTION | DMA_SCR_START };
+                        fpga_reg_set_multiple(REG_USB_DMA_ADDRESS, dma_regs, 3);
                         p.rx_dma_running = true;
                         p.read_ready = false;
                     } else {
@@ -319,9 +369,9 @@ static void usb_rx_process (void) {
             case '?':
                 p.rx_state = RX_STATE_IDLE;
                 p.response_pending = true;
-                p.response_info.data_length = 8;
-                p.response_info.data[0] = fpga_reg_get(REG_DEBUG_0);
-                p.response_info.data[1] = fpga_reg_get(REG_DEBUG_1);
+                p.response_info.data_length = 12;
+                fpga_reg_get_multiple(REG_DEBUG_0, p.response_info.data, 2);
+                p.response_info.data[2] = fpga_spi_saved_get();
                 break;
 
             case '%':
@@ -331,6 +381,41 @@ static void usb_rx_process (void) {
                 app_get_stack_usage(p.response_info.data);
                 break;
 
+            case 'Z':
+                if (!p.rx_dma_running) {
+                    uint32_t pattern;
+                    if (usb_rx_word(&pattern)) {
+                        fpga_mem_fill_start(p.rx_args[0], p.rx_args[1], (pattern & 0xFF));
+                        p.rx_dma_running = true;
+                    }
+                } else if (!fpga_mem_copy_busy()) {
+                    p.rx_state = RX_STATE_IDLE;
+                    p.response_pending = true;
+                }
+                break;
+
+            case 'K':
+                if (!p.rx_dma_running) {
+                    fpga_mem_crc32_start(p.rx_args[0], p.rx_args[1]);
+                    p.rx_dma_running = true;
+                } else if (!fpga_mem_copy_busy()) {
+                    p.rx_state = RX_STATE_IDLE;
+                    p.response_pending = true;
+                    p.response_info.data_length = 4;
+                    p.response_info.data[0] = fpga_mem_crc32_result();
+                }
+                break;
+
+            case '#':
+                p.response_info.data[0] = profile_store(p.rx_args[0]);
+                if (p.rx_args[1]) {
+                    profile_reset();
+                }
+                p.rx_state = RX_STATE_IDLE;
+                p.response_pending = true;
+                p.response_info.data_length = 4;
+                break;
+
             default:
                 p.rx_state = RX_STATE_IDLE;
                 p.response_pending = true;
@@ -340,52 +425,49 @@ static void usb_rx_process (void) {
                 break;
         }
     }
+
+    if (p.response_pending) {
+        usb_response_queue_push();
+    }
+}
+
+static void usb_tx_start (usb_tx_info_t *info, uint32_t token, bool tagged, uint32_t tag) {
+    p.tx_state = TX_STATE_DATA;
+    p.tx_info = *info;
+    p.tx_buffer_length = 0;
+    p.tx_buffer_offset = 0;
+    p.tx_dma_running = false;
+    usb_tx_buffer_put(token | p.tx_info.cmd);
+    usb_tx_buffer_put(p.tx_info.data_length + p.tx_info.dma_length);
+    if (tagged) {
+        usb_tx_buffer_put(tag);
+    }
+    for (int i = 0; i < (p.tx_info.data_length / 4); i++) {
+        usb_tx_buffer_put(p.tx_info.data[i]);
+    }
 }
 
 static void usb_tx_process (void) {
     if (p.tx_state == TX_STATE_IDLE) {
-        if (p.response_pending) {
-            p.response_pending = false;
-            p.tx_state = TX_STATE_TOKEN;
-            p.tx_counter = 0;
-            p.tx_info = p.response_info;
-            p.tx_token = p.response_error ? ERR_TOKEN : CMP_TOKEN;
-            p.tx_dma_running = false;
+        if (p.response_queue_count > 0) {
+            usb_response_t *response = usb_response_queue_pop();
+            uint32_t token;
+            if (response->tagged) {
+                token = response->error ? ERR_TAGGED_TOKEN : CMP_TAGGED_TOKEN;
+            } else {
+                token = response->error ? ERR_TOKEN : CMP_TOKEN;
+            }
+            usb_tx_start(&response->info, token, response->tagged, response->tag);
         } else if (p.packet_pending) {
             p.packet_pending = false;
-            p.tx_state = TX_STATE_TOKEN;
-            p.tx_counter = 0;
-            p.tx_info = p.packet_info;
-            p.tx_token = PKT_TOKEN;
-            p.tx_dma_running = false;
-        }
-    }
-
-    if (p.tx_state == TX_STATE_TOKEN) {
-        if (p.tx_counter == 0) {
-            if (usb_tx_word(p.tx_token | p.tx_info.cmd)) {
-                p.tx_counter += 1;
-            }
-        }
-        if (p.tx_counter == 1) {
-            if (usb_tx_word(p.tx_info.data_length + p.tx_info.dma_length)) {
-                p.tx_state = TX_STATE_DATA;
-                p.tx_counter = 0;
-            }
+            usb_tx_start(&p.packet_info, PKT_TOKEN, false, 0);
         }
     }
 
     if (p.tx_state == TX_STATE_DATA) {
-        if (p.tx_info.data_length > 0) {
-            while (usb_tx_word(p.tx_info.data[p.tx_counter])) {
-                p.tx_counter += 1;
-                if (p.tx_counter == (p.tx_info.data_length / 4)) {
-                    p.tx_state = TX_STATE_DMA;
-                    p.tx_counter = 0;
-                    break;
-                }
-            }
-        } else {
+        uint8_t *buffer = &p.tx_buffer[p.tx_buffer_offset];
+        p.tx_buffer_offset += fpga_usb_write_burst(buffer, p.tx_buffer_length - p.tx_buffer_offset);
+        if (p.tx_buffer_offset == p.tx_buffer_length) {
             p.tx_state = TX_STATE_DMA;
         }
     }
@@ -395,9 +477,8 @@ static void usb_tx_process (void) {
             if (usb_dma_ready()) {
                 if (!p.tx_dma_running) {
                     p.tx_dma_running = true;
-                    fpga_reg_set(REG_USB_DMA_ADDRESS, p.tx_info.dma_address);
-                    fpga_reg_set(REG_USB_DMA_LENGTH, p.tx_info.dma_length);
-                    fpga_reg_set(REG_USB_DMA_SCR, DMA_SCR_START);
+                    uint32_t dma_regs[3] = { p.tx_info.dma_address, p.tx_info.dma_length, DMA_SCR_START };
+                    fpga_reg_set_multiple(REG_USB_DMA_ADDRESS, dma_regs, 3);
                 } else {
                     p.tx_state = TX_STATE_FLUSH;
                 }
@@ -408,7 +489,9 @@ static void usb_tx_process (void) {
     }
 
     if (p.tx_state == TX_STATE_FLUSH) {
-        fpga_reg_set(REG_USB_SCR, USB_SCR_WRITE_FLUSH);
+        if (p.response_queue_count == 0) {
+            fpga_reg_set(REG_USB_SCR, USB_SCR_WRITE_FLUSH);
+        }
         if (p.tx_info.done_callback) {
             p.tx_info.done_callback();
         }
@@ -459,6 +542,16 @@ void usb_get_read_info (uint32_t *args) {
     args[0] |= (scr & USB_SCR_PWRSAV) ? (1 << 29) : 0;
 }
 
+bool usb_is_busy (void) {
+    return (
+        (p.rx_state != RX_STATE_IDLE) ||
+        (p.tx_state != TX_STATE_IDLE) ||
+        p.response_pending ||
+        (p.response_queue_count > 0) ||
+        p.packet_pending
+    );
+}
+
 void usb_init (void) {
     fpga_reg_set(REG_USB_DMA_SCR, DMA_SCR_STOP);
     fpga_reg_set(REG_USB_SCR, USB_SCR_FIFO_FLUSH);
@@ -467,6 +560,8 @@ void usb_init (void) {
     p.tx_state = TX_STATE_IDLE;
 
     p.response_pending = false;
+    p.response_queue_head = 0;
+    p.response_queue_count = 0;
     p.packet_pending = false;
 
     p.read_ready = true;
@@ -474,8 +569,6 @@ void usb_init (void) {
     p.read_address = 0;
 
     usb_rx_word_counter = 0;
-    usb_rx_word_buffer = 0;
-    usb_tx_word_counter = 0;
     usb_rx_cmd_counter = 0;
 }
 
@@ -2,7 +2,7 @@
 
 
 #define VERSION_MAJOR   (2)
-#define VERSION_MINOR   (12)
+#define VERSION_MINOR   (13)
 
 
 uint32_t version_firmware (void) {
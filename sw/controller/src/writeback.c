@@ -14,6 +14,7 @@
 #define FLASHRAM_SECTOR_COUNT       (256)
 #define SRAM_BANKED_SECTOR_COUNT    (192)
 #define WRITEBACK_DELAY_TICKS       (100)
+#define SAVE_DIRTY_WORDS            (SAVE_MAX_SECTOR_COUNT / 32)
 
 
 struct process {
@@ -27,9 +28,25 @@ struct process {
 static struct process p;
 
 
-static void writeback_save_to_sd (void) {
+static void writeback_dirty_clear (void) {
+    uint32_t dirty[SAVE_DIRTY_WORDS];
+    for (int i = 0; i < SAVE_DIRTY_WORDS; i++) {
+        dirty[i] = 0xFFFFFFFFUL;
+    }
+    fpga_reg_set_multiple(REG_SAVE_DIRTY_0, dirty, SAVE_DIRTY_WORDS);
+}
+
+static void writeback_save_done (bool error) {
+    if (error) {
+        writeback_disable();
+    }
+}
+
+static bool writeback_save_to_sd (void) {
     uint32_t address;
     uint32_t count;
+    uint32_t dirty[SAVE_DIRTY_WORDS];
+    uint32_t saved[SAVE_DIRTY_WORDS];
 
     switch (cfg_get_save_type()) {
         case SAVE_TYPE_EEPROM_4K:
@@ -54,12 +71,59 @@ static void writeback_save_to_sd (void) {
             break;
         default:
             writeback_disable();
-            return;
+            return false;
     }
 
-    if(sd_optimize_sectors(address, p.sectors, count, sd_write_sectors)) {
-        writeback_disable();
+    uint32_t runs_available = sd_get_queue_free();
+
+    if (runs_available < 2) {
+        return true;
+    }
+
+    runs_available -= 1;
+
+    fpga_reg_get_multiple(REG_SAVE_DIRTY_0, dirty, SAVE_DIRTY_WORDS);
+
+    for (int i = 0; i < SAVE_DIRTY_WORDS; i++) {
+        saved[i] = 0;
     }
+
+    uint32_t sector = 0;
+    bool remaining = false;
+    bool error = false;
+
+    while (sector < count) {
+        if (!(dirty[sector / 32] & (1UL << (sector % 32)))) {
+            sector += 1;
+            continue;
+        }
+        if (runs_available == 0) {
+            remaining = true;
+            break;
+        }
+        uint32_t starting_sector = sector;
+        uint32_t sd_sector = p.sectors[starting_sector];
+        if (sd_sector == 0) {
+            error = true;
+            break;
+        }
+        do {
+            saved[sector / 32] |= (1UL << (sector % 32));
+            sector += 1;
+        } while (
+            (sector < count) &&
+            (dirty[sector / 32] & (1UL << (sector % 32))) &&
+            (p.sectors[sector] == (sd_sector + (sector - starting_sector)))
+        );
+        sd_enqueue(address + (starting_sector * SD_SECTOR_SIZE), sd_sector, (sector - starting_sector), true, NULL);
+        runs_available -= 1;
+    }
+
+    fpga_reg_set_multiple(REG_SAVE_DIRTY_0, saved, SAVE_DIRTY_WORDS);
+
+    sd_enqueue_complete(error, writeback_save_done);
+
+    return (remaining && !error);
 }
 
 
@@ -74,6 +138,7 @@ void writeback_enable (void) {
     p.enabled = true;
     p.pending = false;
     p.last_save_count = fpga_reg_get(REG_SAVE_COUNT);
+    writeback_dirty_clear();
 }
 
 void writeback_disable (void) {
@@ -82,6 +147,10 @@ void writeback_disable (void) {
     timer_set(TIMER_ID_WRITEBACK, 0);
 }
 
+bool writeback_is_busy (void) {
+    return p.pending;
+}
+
 void writeback_init (void) {
     p.enabled = false;
     p.pending = false;
@@ -105,7 +174,6 @@ void writeback_process (void) {
     }
 
     if (p.pending && (timer_get(TIMER_ID_WRITEBACK) == 0)) {
-        p.pending = false;
-        writeback_save_to_sd();
+        p.pending = writeback_save_to_sd();
     }
 }
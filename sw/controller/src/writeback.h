@@ -12,6 +12,7 @@
 void writeback_load_sector_table (uint32_t address);
 void writeback_enable (void);
 void writeback_disable (void);
+bool writeback_is_busy (void);
 void writeback_init (void);
 void writeback_process (void);
 
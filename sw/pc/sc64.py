@@ -1,6 +1,7 @@
 #!/usr/bin/env python3
 
 import argparse
+import mmap
 import os
 import queue
 import serial
@@ -10,9 +11,9 @@ import time
 from binascii import crc32
 from datetime import datetime
 from enum import Enum, IntEnum
-from io import BufferedReader
+from io import BufferedReader, BufferedWriter
 from serial.tools import list_ports
-from threading import Thread
+from threading import Condition, Thread
 from typing import Callable, Optional
 from PIL import Image
 
@@ -222,6 +223,68 @@ class DD64Image:
         self.__file.write(data)
 
 
+class ROMData:
+    __BYTE_ORDER_WORD_SIZE = {
+        0x80371240: 1,
+        0x37804012: 2,
+        0x40123780: 4,
+    }
+
+    def __init__(self, data, word_size: Optional[int]=None) -> None:
+        self.__mmap = data if isinstance(data, mmap.mmap) else None
+        self.__data = memoryview(data).cast('B')
+        if (word_size == None):
+            pi_config = int.from_bytes(self.__data[0:4], byteorder='big')
+            word_size = self.__BYTE_ORDER_WORD_SIZE.get(pi_config, 1)
+        self.__word_size = word_size
+
+    @classmethod
+    def from_file(cls, path: str) -> 'ROMData':
+        with open(path, 'rb') as f:
+            if (os.fstat(f.fileno()).st_size == 0):
+                return cls(b'')
+            return cls(mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ))
+
+    def __enter__(self) -> 'ROMData':
+        return self
+
+    def __exit__(self, *args) -> None:
+        self.close()
+
+    def close(self) -> None:
+        self.__data.release()
+        if (self.__mmap != None):
+            self.__mmap.close()
+            self.__mmap = None
+
+    def __len__(self) -> int:
+        return len(self.__data)
+
+    def __getitem__(self, key: slice) -> 'ROMData':
+        if (not isinstance(key, slice)):
+            raise TypeError('ROM data can be only sliced')
+        (start, stop, _) = key.indices(len(self.__data))
+        if (start % self.__word_size != 0):
+            raise ValueError('ROM data slice not aligned to byte order word size')
+        return ROMData(self.__data[start:max(start, stop)], self.__word_size)
+
+    def __bytes__(self) -> bytes:
+        return b''.join(self.iter_chunks(len(self.__data)))
+
+    def __fix_byte_order(self, chunk: memoryview) -> bytes:
+        data = bytearray(chunk)
+        if (self.__word_size == 2):
+            data[0::2], data[1::2] = data[1::2], data[0::2]
+        elif (self.__word_size == 4):
+            data[0::4], data[1::4], data[2::4], data[3::4] = data[3::4], data[2::4], data[1::4], data[0::4]
+        return data
+
+    def iter_chunks(self, chunk_size: int):
+        for offset in range(0, len(self.__data), chunk_size):
+            chunk = self.__data[offset:offset + chunk_size]
+            yield chunk if (self.__word_size == 1) else self.__fix_byte_order(chunk)
+
+
 class ConnectionException(Exception):
     pass
 
@@ -234,19 +297,31 @@ class SC64Serial:
     __queue_output = queue.Queue()
     __queue_input = queue.Queue()
     __queue_packet = queue.Queue()
+    __pipelining = False
+    __tag_counter = 0
+    __tagged_responses: dict[int, tuple[bytes, bytes, bool]] = {}
+    __discarded_tags: set[int] = set()
+    __tagged_condition = Condition()
 
     __VID = 0x0403
     __PID = 0x6014
 
     __CHUNK_SIZE = (64 * 1024)
 
-    def __init__(self) -> None:
-        ports = list_ports.comports()
+    def __init__(self, port: Optional[str] = None) -> None:
+        ports = list_ports.comports() if (port == None) else []
         device_found = False
 
         if (self.__serial != None and self.__serial.is_open):
             raise ConnectionException('Serial port is already open')
 
+        if (port != None):
+            try:
+                self.__serial = serial.serial_for_url(port, timeout=1.0, write_timeout=1.0)
+                device_found = True
+            except serial.SerialException:
+                raise ConnectionException(f'Could not open port [{port}]')
+
         for p in ports:
             if (p.vid == self.__VID and p.pid == self.__PID and p.serial_number.startswith('SC64')):
                 try:
@@ -298,21 +373,34 @@ class SC64Serial:
             if (retry_counter >= 10):
                 raise ConnectionException('Could not reset SC64 device')
 
-    def __write(self, data: bytes) -> None:
+    def __iter_chunks(self, data):
+        if (hasattr(data, 'iter_chunks')):
+            yield from data.iter_chunks(self.__CHUNK_SIZE)
+        else:
+            view = memoryview(data)
+            for offset in range(0, len(view), self.__CHUNK_SIZE):
+                yield view[offset:offset + self.__CHUNK_SIZE]
+
+    def __write(self, header: bytes, data=b'') -> None:
         try:
             if (self.__disconnect):
                 raise ConnectionException
-            for offset in range(0, len(data), self.__CHUNK_SIZE):
-                self.__serial.write(data[offset:offset + self.__CHUNK_SIZE])
+            self.__serial.write(header)
+            for chunk in self.__iter_chunks(data):
+                if (self.__disconnect):
+                    raise ConnectionException
+                self.__serial.write(chunk)
             self.__serial.flush()
         except (serial.SerialException, serial.SerialTimeoutException):
             raise ConnectionException
 
     def __read(self, length: int) -> bytes:
         try:
-            data = b''
-            while (len(data) < length and not self.__disconnect):
-                data += self.__serial.read(length - len(data))
+            data = bytearray(length)
+            view = memoryview(data)
+            received = 0
+            while (received < length and not self.__disconnect):
+                received += self.__serial.readinto(view[received:])
             if (self.__disconnect):
                 raise ConnectionException
             return data
@@ -325,8 +413,8 @@ class SC64Serial:
     def __serial_process_output(self) -> None:
         while (not self.__disconnect and self.__serial != None and self.__serial.is_open):
             try:
-                packet: bytes = self.__queue_output.get(timeout=0.1)
-                self.__write(packet)
+                (header, data) = self.__queue_output.get(timeout=0.1)
+                self.__write(header, data)
                 self.__queue_output.task_done()
             except queue.Empty:
                 continue
@@ -347,6 +435,17 @@ class SC64Serial:
                         data = self.__read(self.__read_int())
                         success = identifier == b'CMP'
                         self.__queue_input.put((command, data, success))
+                    elif (identifier == b'CPT' or identifier == b'ERT'):
+                        length = self.__read_int()
+                        tag = self.__read_int()
+                        data = self.__read(length)
+                        success = identifier == b'CPT'
+                        with self.__tagged_condition:
+                            if (tag in self.__discarded_tags):
+                                self.__discarded_tags.remove(tag)
+                            else:
+                                self.__tagged_responses[tag] = (command, data, success)
+                                self.__tagged_condition.notify_all()
                     else:
                         raise ConnectionException
             except ConnectionException:
@@ -356,17 +455,18 @@ class SC64Serial:
         if (not (self.__thread_write.is_alive() and self.__thread_read.is_alive())):
             raise ConnectionException('Serial link is closed')
 
-    def __queue_cmd(self, cmd: bytes, args: list[int]=[0, 0], data: bytes=b'') -> None:
+    def __queue_cmd(self, cmd: bytes, args: list[int]=[0, 0], data=b'', tag: Optional[int]=None) -> None:
         if (len(cmd) != 1):
             raise ValueError('Length of command is different than 1 byte')
         if (len(args) != 2):
             raise ValueError('Number of arguments is different than 2')
-        packet: bytes = b'CMD'
+        packet: bytes = b'CMD' if (tag == None) else b'CMT'
         packet += cmd[0:1]
+        if (tag != None):
+            packet += tag.to_bytes(4, byteorder='big')
         for arg in args:
             packet += arg.to_bytes(4, byteorder='big')
-        packet += data
-        self.__queue_output.put(packet)
+        self.__queue_output.put((packet, data))
 
     def __pop_response(self, cmd: bytes, timeout: float, raise_on_err: bool) -> bytes:
         try:
@@ -380,8 +480,61 @@ class SC64Serial:
         except queue.Empty:
             raise ConnectionException('CMD response timeout')
 
-    def execute_cmd(self, cmd: bytes, args: list[int]=[0, 0], data: bytes=b'', response: bool=True, timeout: float=5.0, raise_on_err: bool=True) -> Optional[bytes]:
+    def __pop_tagged_response(self, cmd: bytes, tag: int, timeout: float, raise_on_err: bool) -> bytes:
+        with self.__tagged_condition:
+            if (not self.__tagged_condition.wait_for(lambda: tag in self.__tagged_responses, timeout=timeout)):
+                self.__discarded_tags.add(tag)
+                raise ConnectionException('CMD response timeout')
+            (response_cmd, data, success) = self.__tagged_responses.pop(tag)
+        if (cmd != response_cmd):
+            raise ConnectionException('CMD wrong command response')
+        if (raise_on_err and success == False):
+            raise ConnectionException('CMD response error')
+        return data
+
+    def __discard_tagged_responses(self, tags: list[int]) -> None:
+        with self.__tagged_condition:
+            for tag in tags:
+                if (tag in self.__tagged_responses):
+                    self.__tagged_responses.pop(tag)
+                else:
+                    self.__discarded_tags.add(tag)
+
+    def __submit_tagged_cmd(self, cmd: bytes, args: list[int], data) -> int:
+        tag = self.__tag_counter
+        self.__tag_counter = (self.__tag_counter + 1) & 0xFFFFFFFF
+        self.__queue_cmd(cmd, args, data, tag=tag)
+        return tag
+
+    def set_pipelining(self, enabled: bool) -> None:
+        self.__pipelining = enabled
+
+    def submit_cmd(self, cmd: bytes, args: list[int]=[0, 0], data=b'', timeout: float=5.0, raise_on_err: bool=True) -> Callable[[], bytes]:
+        self.__check_threads()
+        if (not self.__pipelining):
+            response = self.execute_cmd(cmd, args, data, timeout=timeout, raise_on_err=raise_on_err)
+            return lambda: response
+        tag = self.__submit_tagged_cmd(cmd, args, data)
+        return lambda: self.__pop_tagged_response(cmd, tag, timeout, raise_on_err)
+
+    def execute_cmds(self, cmds: list[tuple[bytes, list[int], object]], timeout: float=5.0, raise_on_err: bool=True) -> list[bytes]:
         self.__check_threads()
+        if (not self.__pipelining):
+            return [self.execute_cmd(cmd, args, data, timeout=timeout, raise_on_err=raise_on_err) for (cmd, args, data) in cmds]
+        pending = [(cmd, self.__submit_tagged_cmd(cmd, args, data)) for (cmd, args, data) in cmds]
+        responses = []
+        try:
+            for (cmd, tag) in pending:
+                responses.append(self.__pop_tagged_response(cmd, tag, timeout, raise_on_err))
+        except:
+            self.__discard_tagged_responses([tag for (_, tag) in pending[len(responses) + 1:]])
+            raise
+        return responses
+
+    def execute_cmd(self, cmd: bytes, args: list[int]=[0, 0], data=b'', response: bool=True, timeout: float=5.0, raise_on_err: bool=True) -> Optional[bytes]:
+        self.__check_threads()
+        if (self.__pipelining and response):
+            return self.submit_cmd(cmd, args, data, timeout, raise_on_err)()
         self.__queue_cmd(cmd, args, data)
         if (response):
             return self.__pop_response(cmd, timeout, raise_on_err)
@@ -526,15 +679,17 @@ class SC64:
         SCREENSHOT = 4
         GDB = 0xDB
 
+    __DELTA_BLOCK_SIZE = (64 * 1024)
+
     __SUPPORTED_MAJOR_VERSION = 2
-    __SUPPORTED_MINOR_VERSION = 12
+    __SUPPORTED_MINOR_VERSION = 13
 
     __isv_line_buffer: bytes = b''
     __debug_header: Optional[bytes] = None
     __gdb_client: Optional[socket.socket] = None
 
-    def __init__(self) -> None:
-        self.__link = SC64Serial()
+    def __init__(self, port: Optional[str] = None) -> None:
+        self.__link = SC64Serial(port)
         identifier = self.__link.execute_cmd(cmd=b'v')
         if (identifier != b'SCv2'):
             raise ConnectionException('Unknown SC64 v2 identifier')
@@ -551,6 +706,7 @@ class SC64:
                 raise ConnectionException()
             if (minor < self.__SUPPORTED_MINOR_VERSION):
                 raise ConnectionException()
+            self.__link.set_pipelining(True)
             return (f'{major}.{minor}', minor > self.__SUPPORTED_MINOR_VERSION)
         except ConnectionException:
             raise ConnectionException(f'Unsupported SC64 version [{major}.{minor}], please update firmware')
@@ -568,6 +724,13 @@ class SC64:
             raise ValueError(f'Could not get config {config.name}')
         return self.__get_int(data)
 
+    def __get_configs(self, configs: list[__CfgId]) -> list[int]:
+        try:
+            responses = self.__link.execute_cmds([(b'c', [config, 0], b'') for config in configs])
+        except ConnectionException:
+            raise ValueError(f'Could not get configs {", ".join(config.name for config in configs)}')
+        return [self.__get_int(data) for data in responses]
+
     def __set_setting(self, setting: __SettingId, value: int) -> None:
         try:
             self.__link.execute_cmd(cmd=b'A', args=[setting, value])
@@ -581,7 +744,7 @@ class SC64:
             raise ValueError(f'Could not get setting {setting.name}')
         return self.__get_int(data)
 
-    def __write_memory(self, address: int, data: bytes) -> None:
+    def __write_memory(self, address: int, data) -> None:
         if (len(data) > 0):
             self.__link.execute_cmd(cmd=b'M', args=[address, len(data)], data=data, timeout=20.0)
 
@@ -590,6 +753,50 @@ class SC64:
             return self.__link.execute_cmd(cmd=b'm', args=[address, length], timeout=20.0)
         return bytes([])
 
+    def __fill_memory(self, address: int, length: int, value: int) -> None:
+        if (length > 0):
+            self.__link.execute_cmd(cmd=b'Z', args=[address, length], data=value.to_bytes(4, byteorder='big'), timeout=20.0)
+
+    def __checksum_memory(self, address: int, length: int) -> int:
+        if (length > 0):
+            data = self.__link.execute_cmd(cmd=b'K', args=[address, length], timeout=20.0)
+            return self.__get_int(data)
+        return 0
+
+    def __calculate_checksum(self, data) -> int:
+        checksum = 0
+        chunks = data.iter_chunks(1 * 1024 * 1024) if hasattr(data, 'iter_chunks') else [data]
+        for chunk in chunks:
+            checksum = crc32(chunk, checksum)
+        return checksum
+
+    def __write_memory_delta(self, address: int, data) -> int:
+        block_size = self.__DELTA_BLOCK_SIZE
+        length = len(data)
+        offsets = range(0, length, block_size)
+        checksum_cmds = [(b'K', [address + offset, min(block_size, length - offset)], b'') for offset in offsets]
+        checksums = self.__link.execute_cmds(checksum_cmds, timeout=20.0)
+        changed = [(self.__get_int(checksum) != self.__calculate_checksum(data[offset:offset + block_size])) for (offset, checksum) in zip(offsets, checksums)]
+        written = 0
+        run_start = None
+        for (offset, block_changed) in zip(list(offsets) + [length], changed + [False]):
+            if (block_changed and run_start == None):
+                run_start = offset
+            elif (not block_changed and run_start != None):
+                self.__write_memory(address + run_start, data[run_start:offset])
+                written += (offset - run_start)
+                run_start = None
+        return written
+
+    def __read_memory_to_file(self, address: int, length: int, f: BufferedWriter) -> None:
+        read_chunk_size = (1 * 1024 * 1024)
+        pending = []
+        for offset in range(0, length, read_chunk_size):
+            chunk_length = min(read_chunk_size, length - offset)
+            pending.append(self.__link.submit_cmd(cmd=b'm', args=[address + offset, chunk_length], timeout=20.0))
+        for wait_response in pending:
+            f.write(wait_response())
+
     def __dd_set_block_ready(self, error: int) -> None:
         self.__link.execute_cmd(cmd=b'D', args=[error, 0])
 
@@ -600,9 +807,6 @@ class SC64:
         data = self.__link.execute_cmd(cmd=b'p', args=[False, 0])
         return self.__get_int(data[0:4])
 
-    def __flash_erase_block(self, address: int) -> None:
-        self.__link.execute_cmd(cmd=b'P', args=[address, 0])
-
     def __erase_flash_region(self, address: int, length: int) -> None:
         if (address < self.__Address.FLASH):
             raise ValueError('Flash erase address or length outside of possible range')
@@ -611,18 +815,33 @@ class SC64:
         erase_block_size = self.__flash_get_erase_block_size()
         if (address % erase_block_size != 0):
             raise ValueError('Flash erase address not aligned to block size')
-        for offset in range(address, address + length, erase_block_size):
-            self.__flash_erase_block(offset)
+        erase_cmds = [(b'P', [offset, 0], b'') for offset in range(address, address + length, erase_block_size)]
+        self.__link.execute_cmds(erase_cmds)
 
-    def __program_flash(self, address: int, data: bytes):
+    def __program_flash(self, address: int, data: bytes, status_callback: Optional[Callable[[str], None]]=None) -> int:
         program_chunk_size = (128 * 1024)
-        if (self.__read_memory(address, len(data)) != data):
-            self.__erase_flash_region(address, len(data))
-            for offset in range(0, len(data), program_chunk_size):
-                self.__write_memory(address + offset, data[offset:offset + program_chunk_size])
-            self.__flash_wait_busy()
-            if (self.__read_memory(address, len(data)) != data):
-                raise ConnectionException('Flash memory program failure')
+        data = bytes(data)
+        checksum = self.__calculate_checksum(data)
+        if (self.__checksum_memory(address, len(data)) == checksum):
+            return 0
+        erase_block_size = self.__flash_get_erase_block_size()
+        offsets = range(0, len(data), erase_block_size)
+        checksum_cmds = [(b'K', [address + offset, min(erase_block_size, len(data) - offset)], b'') for offset in offsets]
+        checksums = self.__link.execute_cmds(checksum_cmds, timeout=20.0)
+        changed_offsets = [offset for (offset, block_checksum) in zip(offsets, checksums) if (self.__get_int(block_checksum) != crc32(data[offset:offset + erase_block_size]))]
+        written = 0
+        for (index, offset) in enumerate(changed_offsets):
+            block = data[offset:offset + erase_block_size]
+            self.__erase_flash_region(address + offset, len(block))
+            for chunk_offset in range(0, len(block), program_chunk_size):
+                self.__write_memory(address + offset + chunk_offset, block[chunk_offset:chunk_offset + program_chunk_size])
+            written += len(block)
+            if (status_callback):
+                status_callback(f'[{index + 1}/{len(changed_offsets)}]')
+        self.__flash_wait_busy()
+        if (self.__checksum_memory(address, len(data)) != checksum):
+            raise ConnectionException('Flash memory program failure')
+        return written
 
     def autodetect_save_type(self, data: bytes) -> SaveType:
         if (len(data) < 0x40):
@@ -708,22 +927,23 @@ class SC64:
         self.__link.execute_cmd(cmd=b'R')
 
     def get_state(self):
+        config = dict(zip(self.__CfgId, self.__get_configs(list(self.__CfgId))))
         return {
-            'bootloader_switch': bool(self.__get_config(self.__CfgId.BOOTLOADER_SWITCH)),
-            'rom_write_enable': bool(self.__get_config(self.__CfgId.ROM_WRITE_ENABLE)),
-            'rom_shadow_enable': bool(self.__get_config(self.__CfgId.ROM_SHADOW_ENABLE)),
-            'dd_mode': self.__DDMode(self.__get_config(self.__CfgId.DD_MODE)),
-            'isv_address': self.__get_config(self.__CfgId.ISV_ADDRESS),
-            'boot_mode': self.BootMode(self.__get_config(self.__CfgId.BOOT_MODE)),
-            'save_type': self.SaveType(self.__get_config(self.__CfgId.SAVE_TYPE)),
-            'cic_seed': self.CICSeed(self.__get_config(self.__CfgId.CIC_SEED)),
-            'tv_type': self.TVType(self.__get_config(self.__CfgId.TV_TYPE)),
-            'dd_sd_enable': bool(self.__get_config(self.__CfgId.DD_SD_ENABLE)),
-            'dd_drive_type': self.__DDDriveType(self.__get_config(self.__CfgId.DD_DRIVE_TYPE)),
-            'dd_disk_state': self.__DDDiskState(self.__get_config(self.__CfgId.DD_DISK_STATE)),
-            'button_state': bool(self.__get_config(self.__CfgId.BUTTON_STATE)),
-            'button_mode': self.__ButtonMode(self.__get_config(self.__CfgId.BUTTON_MODE)),
-            'rom_extended_enable': bool(self.__get_config(self.__CfgId.ROM_EXTENDED_ENABLE)),
+            'bootloader_switch': bool(config[self.__CfgId.BOOTLOADER_SWITCH]),
+            'rom_write_enable': bool(config[self.__CfgId.ROM_WRITE_ENABLE]),
+            'rom_shadow_enable': bool(config[self.__CfgId.ROM_SHADOW_ENABLE]),
+            'dd_mode': self.__DDMode(config[self.__CfgId.DD_MODE]),
+            'isv_address': config[self.__CfgId.ISV_ADDRESS],
+            'boot_mode': self.BootMode(config[self.__CfgId.BOOT_MODE]),
+            'save_type': self.SaveType(config[self.__CfgId.SAVE_TYPE]),
+            'cic_seed': self.CICSeed(config[self.__CfgId.CIC_SEED]),
+            'tv_type': self.TVType(config[self.__CfgId.TV_TYPE]),
+            'dd_sd_enable': bool(config[self.__CfgId.DD_SD_ENABLE]),
+            'dd_drive_type': self.__DDDriveType(config[self.__CfgId.DD_DRIVE_TYPE]),
+            'dd_disk_state': self.__DDDiskState(config[self.__CfgId.DD_DISK_STATE]),
+            'button_state': bool(config[self.__CfgId.BUTTON_STATE]),
+            'button_mode': self.__ButtonMode(config[self.__CfgId.BUTTON_MODE]),
+            'rom_extended_enable': bool(config[self.__CfgId.ROM_EXTENDED_ENABLE]),
             'led_enable': bool(self.__get_setting(self.__SettingId.LED_ENABLE)),
         }
 
@@ -732,28 +952,42 @@ class SC64:
             raise ValueError('Debug data size too big')
         self.__link.execute_cmd(cmd=b'U', args=[datatype, len(data)], data=data, response=False)
 
-    def download_memory(self, address: int, length: int) -> bytes:
+    def download_memory(self, address: int, length: int, f: Optional[BufferedWriter]=None) -> Optional[bytes]:
         if ((address < 0) or (length < 0) or ((address + length) > self.__Address.END)):
             raise ValueError('Invalid address or length')
+        if (f != None):
+            self.__read_memory_to_file(address, length, f)
+            return None
         return self.__read_memory(address, length)
 
-    def upload_rom(self, data: bytes, use_shadow: bool=True) -> None:
+    def upload_rom(self, data: ROMData, use_shadow: bool=True, delta: bool=False, status_callback: Optional[Callable[[str], None]]=None) -> int:
+        if (not isinstance(data, ROMData)):
+            data = ROMData(data)
         rom_length = len(data)
         if (rom_length > (self.__Length.SDRAM + self.__Length.EXTENDED)):
             raise ValueError('ROM size too big')
         sdram_length = self.__Length.SDRAM
         shadow_enabled = use_shadow and rom_length > (self.__Length.SDRAM - self.__Length.SHADOW)
         extended_enabled = rom_length > self.__Length.SDRAM
+        written = 0
         if (shadow_enabled):
             sdram_length = (self.__Length.SDRAM - self.__Length.SHADOW)
             shadow_data = data[sdram_length:sdram_length + self.__Length.SHADOW]
-            self.__program_flash(self.__Address.SHADOW, shadow_data)
+            written += self.__program_flash(self.__Address.SHADOW, shadow_data, status_callback)
         self.__set_config(self.__CfgId.ROM_SHADOW_ENABLE, shadow_enabled)
         if (extended_enabled):
             extended_data = data[self.__Length.SDRAM:]
-            self.__program_flash(self.__Address.EXTENDED, extended_data)
+            written += self.__program_flash(self.__Address.EXTENDED, extended_data, status_callback)
         self.__set_config(self.__CfgId.ROM_EXTENDED_ENABLE, extended_enabled)
-        self.__write_memory(self.__Address.SDRAM, data[:sdram_length])
+        sdram_data = data[:sdram_length]
+        if (delta):
+            written += self.__write_memory_delta(self.__Address.SDRAM, sdram_data)
+        else:
+            self.__write_memory(self.__Address.SDRAM, sdram_data)
+            written += len(sdram_data)
+        if (self.__checksum_memory(self.__Address.SDRAM, len(sdram_data)) != self.__calculate_checksum(sdram_data)):
+            raise ConnectionException('ROM upload verification failure')
+        return written
 
     def upload_ddipl(self, data: bytes) -> None:
         if (len(data) > self.__Length.DDIPL):
@@ -771,7 +1005,7 @@ class SC64:
             address = self.__Address.EEPROM
         self.__write_memory(address, data)
 
-    def download_save(self) -> bytes:
+    def clear_save(self) -> None:
         save_type = self.SaveType(self.__get_config(self.__CfgId.SAVE_TYPE))
         if (save_type == self.SaveType.NONE):
             raise ValueError('No save type set inside SC64 device')
@@ -779,18 +1013,29 @@ class SC64:
         length = self.__SaveLength[save_type.name]
         if (save_type == self.SaveType.EEPROM_4K or save_type == self.SaveType.EEPROM_16K):
             address = self.__Address.EEPROM
+        self.__fill_memory(address, length, 0xFF)
+
+    def clear_rom(self) -> None:
+        self.__fill_memory(self.__Address.SDRAM, self.__Length.SDRAM - self.__Length.SAVE, 0x00)
+
+    def download_save(self, f: Optional[BufferedWriter]=None) -> Optional[bytes]:
+        save_type = self.SaveType(self.__get_config(self.__CfgId.SAVE_TYPE))
+        if (save_type == self.SaveType.NONE):
+            raise ValueError('No save type set inside SC64 device')
+        address = self.__Address.SAVE
+        length = self.__SaveLength[save_type.name]
+        if (save_type == self.SaveType.EEPROM_4K or save_type == self.SaveType.EEPROM_16K):
+            address = self.__Address.EEPROM
+        if (f != None):
+            self.__read_memory_to_file(address, length, f)
+            return None
         return self.__read_memory(address, length)
 
-    def upload_bootloader(self, data: bytes) -> None:
+    def upload_bootloader(self, data: bytes) -> int:
         if (len(data) > self.__Length.BOOTLOADER):
             raise ValueError('Bootloader size too big')
         padded_data = data + (b'\xFF' * (self.__Length.BOOTLOADER - len(data)))
-        if (self.__read_memory(self.__Address.BOOTLOADER, self.__Length.BOOTLOADER) != padded_data):
-            self.__erase_flash_region(self.__Address.BOOTLOADER, self.__Length.BOOTLOADER)
-            self.__write_memory(self.__Address.BOOTLOADER, data)
-            self.__flash_wait_busy()
-            if (self.__read_memory(self.__Address.BOOTLOADER, self.__Length.BOOTLOADER) != padded_data):
-                raise ConnectionException('Bootloader program failure')
+        return self.__program_flash(self.__Address.BOOTLOADER, padded_data)
 
     def set_rtc(self, t: datetime) -> None:
         to_bcd = lambda v: ((int((v / 10) % 10) << 4) | int(int(v) % 10))
@@ -827,6 +1072,62 @@ class SC64:
     def set_led_enable(self, enabled: bool) -> None:
         self.__set_setting(self.__SettingId.LED_ENABLE, enabled)
 
+    def benchmark_transfer(self, length: int) -> tuple[float, float]:
+        if (length > self.__Length.SDRAM):
+            raise ValueError('Benchmark length too big')
+        data = os.urandom(length)
+        start = time.perf_counter()
+        self.__write_memory(self.__Address.SDRAM, data)
+        upload_time = time.perf_counter() - start
+        start = time.perf_counter()
+        readback = self.__read_memory(self.__Address.SDRAM, length)
+        download_time = time.perf_counter() - start
+        if (readback != data):
+            raise ConnectionException('Benchmark data verify failure')
+        to_mb_per_second = lambda seconds: ((length / (1 * 1024 * 1024)) / seconds)
+        return (to_mb_per_second(upload_time), to_mb_per_second(download_time))
+
+    def benchmark_delta_upload(self, length: int, changed_length: int) -> tuple[float, float]:
+        if (length > self.__Length.SDRAM or changed_length > length):
+            raise ValueError('Benchmark length too big')
+        data = bytearray(os.urandom(length))
+        start = time.perf_counter()
+        self.__write_memory(self.__Address.SDRAM, data)
+        full_time = time.perf_counter() - start
+        offset = (length - changed_length) // 2
+        data[offset:offset + changed_length] = os.urandom(changed_length)
+        start = time.perf_counter()
+        self.__write_memory_delta(self.__Address.SDRAM, data)
+        delta_time = time.perf_counter() - start
+        if (self.__checksum_memory(self.__Address.SDRAM, length) != self.__calculate_checksum(data)):
+            raise ConnectionException('Benchmark data verify failure')
+        return (full_time, delta_time)
+
+    __PROFILE_TASKS = ['CIC', 'RTC', 'LED', 'GVR', 'IDLE']
+    __PROFILE_PROCESSES = ['button', 'cfg', 'dd', 'isv', 'rtc', 'sd', 'usb', 'writeback']
+    __PROFILE_LATENCIES = ['CFG command', 'DD command']
+
+    def get_profile(self, reset: bool=False) -> dict:
+        address = self.__Address.BUFFER
+        response = self.__link.execute_cmd(cmd=b'#', args=[address, 1 if reset else 0])
+        length = self.__get_int(response[0:4])
+        data = self.__read_memory(address, length)
+        words = [self.__get_int(data[i:i + 4]) for i in range(0, length, 4)]
+        get_u64 = lambda index: (words[index] | (words[index + 1] << 32))
+        (clock, elapsed, tasks, processes, latencies) = (words[0], get_u64(1), words[3], words[4], words[5])
+        offset = 6
+        profile = { 'clock': clock, 'elapsed': elapsed, 'tasks': [], 'processes': [], 'latencies': [] }
+        for i in range(tasks):
+            name = self.__PROFILE_TASKS[i] if i < len(self.__PROFILE_TASKS) else f'task {i}'
+            profile['tasks'].append((name, get_u64(offset)))
+            offset += 2
+        for (key, names, count) in [('processes', self.__PROFILE_PROCESSES, processes), ('latencies', self.__PROFILE_LATENCIES, latencies)]:
+            for i in range(count):
+                name = names[i] if i < len(names) else f'{key} {i}'
+                profile[key].append((name, words[offset], get_u64(offset + 1), words[offset + 3]))
+                offset += 4
+        return profile
+
     def update_firmware(self, data: bytes, status_callback: Optional[Callable[[str], None]]=None) -> None:
         address = self.__Address.FIRMWARE
         self.__write_memory(address, data)
@@ -1038,8 +1339,10 @@ class SC64:
                 raise BadBlockError
             if (cmd == CMD_READ_BLOCK):
                 block_data = dd.read_block(track, head, block)
-                self.__write_memory(address, block_data)
-                self.__dd_set_block_ready(0)
+                self.__link.execute_cmds([
+                    (b'M', [address, len(block_data)], block_data),
+                    (b'D', [0, 0], b''),
+                ], timeout=20.0)
             elif (cmd == CMD_WRITE_BLOCK):
                 block_data = data[12:]
                 dd.write_block(track, head, block, block_data)
@@ -1272,6 +1575,7 @@ if __name__ == '__main__':
 
     parser = argparse.ArgumentParser(description='SC64 control software')
     parser.add_argument('rom', nargs='?', help='upload ROM from specified file')
+    parser.add_argument('--port', metavar='url', help='connect to SC64 through specified serial port URL instead of autodetecting it (e.g. socket://localhost:6464 for the host simulator)')
     parser.add_argument('--backup-firmware', metavar='file', help='backup SC64 firmware and write it to specified file')
     parser.add_argument('--update-firmware', metavar='file', help='update SC64 firmware from specified file')
     parser.add_argument('--reset-state', action='store_true', help='reset SC64 internal state')
@@ -1280,9 +1584,12 @@ if __name__ == '__main__':
     parser.add_argument('--rtc', action='store_true', help='update clock in SC64 to system time')
     parser.add_argument('--boot', type=SC64.BootMode, action=EnumAction, help='set boot mode')
     parser.add_argument('--tv', type=SC64.TVType, action=EnumAction, help='force TV type to set value, ignored when one of direct boot modes are selected')
+    parser.add_argument('--delta', action='store_true', help='upload only ROM blocks that differ from data already present in SC64 SDRAM')
     parser.add_argument('--no-shadow', action='store_false', help='do not put last 128 kB of ROM inside flash memory (can corrupt non EEPROM saves)')
     parser.add_argument('--save-type', type=SC64.SaveType, action=EnumAction, help='set save type')
     parser.add_argument('--save', metavar='file', help='upload save from specified file')
+    parser.add_argument('--clear-save', action='store_true', help='erase save memory inside SC64 without uploading any data')
+    parser.add_argument('--clear-rom', action='store_true', help='clear ROM area in SDRAM with zeros (does not touch save memory)')
     parser.add_argument('--backup-save', metavar='file', help='download save and write it to specified file')
     parser.add_argument('--ddipl', metavar='file', help='upload 64DD IPL from specified file')
     parser.add_argument('--disk', metavar='file', action='append', help='path to 64DD disk (.ndd format), can be specified multiple times')
@@ -1290,6 +1597,8 @@ if __name__ == '__main__':
     parser.add_argument('--gdb', metavar='port', type=int, help='expose TCP socket port for GDB debugging')
     parser.add_argument('--debug', action='store_true', help='run debug loop')
     parser.add_argument('--download-memory', metavar='address,length,[file]', type=download_memory_type, help='download specified memory region and write it to file')
+    parser.add_argument('--benchmark', action='store_true', help='measure USB transfer speed with 1, 16 and 64 MiB transfers and delta upload time versus changed data size (overwrites SDRAM contents)')
+    parser.add_argument('--profile', action='store_true', help='print controller CPU time and request latency collected since last profile readout')
 
     if (len(sys.argv) <= 1):
         parser.print_help()
@@ -1297,17 +1606,8 @@ if __name__ == '__main__':
 
     args = parser.parse_args()
 
-    def fix_rom_endianness(rom: bytes) -> bytes:
-        data = bytearray(rom)
-        pi_config = int.from_bytes(rom[0:4], byteorder='big')
-        if (pi_config == 0x37804012):
-            data[0::2], data[1::2] = data[1::2], data[0::2]
-        elif (pi_config == 0x40123780):
-            data[0::4], data[1::4], data[2::4], data[3::4] = data[3::4], data[2::4], data[1::4], data[0::4]
-        return bytes(data)
-
     try:
-        sc64 = SC64()
+        sc64 = SC64(args.port)
         autodetected_save_type = None
 
         if (args.backup_firmware):
@@ -1347,13 +1647,18 @@ if __name__ == '__main__':
             sc64.set_rtc(value)
             print(f'RTC set to [{value.strftime("%Y-%m-%d %H:%M:%S")}]')
 
+        if (args.clear_rom):
+            print('Clearing ROM area... ', end='', flush=True)
+            sc64.clear_rom()
+            print('done')
+
         if (args.rom):
-            with open(args.rom, 'rb') as f:
-                rom_data = fix_rom_endianness(f.read())
+            with ROMData.from_file(args.rom) as rom_data:
                 print(f'Uploading ROM ({len(rom_data) / (1 * 1024 * 1024):.2f} MiB)... ', end='', flush=True)
-                sc64.upload_rom(rom_data, use_shadow=args.no_shadow)
-                autodetected_save_type = sc64.autodetect_save_type(rom_data)
-                print('done')
+                status_callback = lambda status: print(f'{status} ', end='', flush=True)
+                written = sc64.upload_rom(rom_data, use_shadow=args.no_shadow, delta=args.delta, status_callback=status_callback)
+                autodetected_save_type = sc64.autodetect_save_type(bytes(rom_data[0:0x40]))
+                print(f'done ({written / 1024:.0f} KiB written)')
 
         if (args.ddipl):
             with open(args.ddipl, 'rb') as f:
@@ -1385,6 +1690,11 @@ if __name__ == '__main__':
             sc64.set_save_type(save_type)
             print(f'Save type set to [{save_type.name}]{" (autodetected)" if autodetected_save_type != None else ""}')
 
+        if (args.clear_save):
+            print('Clearing save... ', end='', flush=True)
+            sc64.clear_save()
+            print('done')
+
         if (args.save):
             with open(args.save, 'rb') as f:
                 print('Uploading save... ', end='', flush=True)
@@ -1405,15 +1715,42 @@ if __name__ == '__main__':
         if (args.backup_save):
             with open(args.backup_save, 'wb') as f:
                 print('Downloading save... ', end='', flush=True)
-                f.write(sc64.download_save())
+                sc64.download_save(f)
                 print('done')
 
         if (args.download_memory != None):
             (address, length, file) = args.download_memory
             with open(file, 'wb') as f:
                 print('Downloading memory... ', end='', flush=True)
-                f.write(sc64.download_memory(address, length))
+                sc64.download_memory(address, length, f)
                 print('done')
+
+        if (args.benchmark):
+            for length_mib in [1, 16, 64]:
+                print(f'Benchmarking {length_mib} MiB transfer... ', end='', flush=True)
+                (upload_speed, download_speed) = sc64.benchmark_transfer(length_mib * 1024 * 1024)
+                print(f'upload: {upload_speed:.2f} MiB/s, download: {download_speed:.2f} MiB/s')
+            for changed_kib in [0, 4, 256, 4096, 16384]:
+                print(f'Benchmarking 16 MiB delta upload with {changed_kib} KiB changed... ', end='', flush=True)
+                (full_time, delta_time) = sc64.benchmark_delta_upload(16 * 1024 * 1024, changed_kib * 1024)
+                print(f'full: {full_time:.3f} s, delta: {delta_time:.3f} s')
+
+        if (args.profile):
+            profile = sc64.get_profile(reset=True)
+            to_us = lambda cycles: ((cycles * 1000000) / profile['clock'])
+            elapsed = max(profile['elapsed'], 1)
+            print(f'Controller profile over {to_us(profile["elapsed"]) / 1000000:.3f} s')
+            print('Tasks:')
+            for (name, cycles) in profile['tasks']:
+                print(f' {name:<10} {(cycles * 100) / elapsed:6.2f} %')
+            print('Processes:              calls   total [ms]   avg [us]   max [us]')
+            for (name, calls, total, max_cycles) in profile['processes']:
+                average = to_us(total / calls) if calls > 0 else 0
+                print(f' {name:<20} {calls:>8} {to_us(total) / 1000:>12.3f} {average:>10.2f} {to_us(max_cycles):>10.2f}')
+            print('Latency:                count   avg [us]   max [us]')
+            for (name, count, total, max_cycles) in profile['latencies']:
+                average = to_us(total / count) if count > 0 else 0
+                print(f' {name:<20} {count:>8} {average:>10.2f} {to_us(max_cycles):>10.2f}')
     except ValueError as e:
         print(f'\n\x1b[31mValue error: {e}\x1b[0m\n')
     except ConnectionException as e: